@@ -0,0 +1,181 @@
+﻿// CteniSlozky.cpp: Vycet polozek slozky a otisk slozky, viz CteniSlozky.h
+
+#include "CteniSlozky.h"
+#include "PocitadloDotazu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <climits>
+#endif
+
+DirectoryStamp DirectoryStamp::of(const std::string& path) {
+    DirectoryStamp stamp;
+#ifdef __linux__
+    struct statx stx {};
+    timespec now {};
+    ::clock_gettime(CLOCK_REALTIME, &now); // pred dotazem, jinak by zmena tesne po nem mohla vypadat starsi
+    if (::statx(AT_FDCWD, path.c_str(), 0, STATX_MTIME | STATX_CTIME | STATX_INO | STATX_NLINK, &stx) == 0) {
+        stamp.mtime = stx.stx_mtime.tv_sec * 1000000000LL + stx.stx_mtime.tv_nsec;
+        stamp.ctime = stx.stx_ctime.tv_sec * 1000000000LL + stx.stx_ctime.tv_nsec;
+        stamp.inode = stx.stx_ino;
+        stamp.links = stx.stx_nlink;
+        stamp.takenAt = now.tv_sec * 1000000000LL + now.tv_nsec;
+        stamp.valid = true;
+    }
+#else
+    std::error_code ec;
+    auto now = fs::file_time_type::clock::now();
+    auto time = fs::last_write_time(path, ec);
+    if (!ec) {
+        stamp.mtime = stamp.ctime = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        stamp.takenAt = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        stamp.valid = true;
+    }
+#endif
+    return stamp;
+}
+
+bool DirectoryStamp::matches(const DirectoryStamp& now) const {
+    // casy souboru maji hrubou granularitu: zmena v tomtez tiku jako otisk by ho nezmenila,
+    // proto se otisku s cerstvou zmenou neveri (stejne jako "racy" zaznamy v indexu gitu)
+    const std::int64_t granularity = 100000000; // 100 ms, vic nez jeden tik jadra
+    return valid && now.valid && mtime == now.mtime && ctime == now.ctime && inode == now.inode && links == now.links
+        && std::max(mtime, ctime) + granularity < takenAt;
+}
+
+EntryInfo loadInfo(const fs::directory_entry& entry) {
+    EntryInfo info;
+    info.metaLoaded = true;
+    std::error_code ec;
+    info.isDirectory = entry.is_directory(ec);
+    ++fsCalls;
+    if (!info.isDirectory) {
+        auto size = entry.file_size(ec);
+        ++fsCalls;
+        if (!ec) {
+            info.size = size;
+            info.sizeKnown = true;
+        }
+    }
+    auto ftime = entry.last_write_time(ec);
+    ++fsCalls;
+    if (!ec) {
+        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+        info.modified = std::chrono::system_clock::to_time_t(sctp);
+        info.timeKnown = true;
+    }
+    return info;
+} // typ, velikost a cas posledni upravy se ctou jen jednou pri obnoveni seznamu
+
+#ifdef __linux__
+bool statEntry(int dirfd, const char* name, EntryInfo& info) {
+    struct statx stx {};
+    ++fsCalls;
+    if (::statx(dirfd, name, AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) {
+        info.metaLoaded = true; // nepovedlo se, zobrazi se N/A a znovu se to nezkousi
+        return false;
+    }
+    info.isDirectory = S_ISDIR(stx.stx_mode);
+    info.size = stx.stx_size;
+    info.sizeKnown = !info.isDirectory;
+    info.modified = static_cast<std::time_t>(stx.stx_mtime.tv_sec);
+    info.timeKnown = true;
+    info.metaLoaded = true;
+    return true;
+}
+
+int openBelow(int root, const std::string& path) {
+    const size_t limit = PATH_MAX / 2;
+    int fd = root;
+    for (size_t start = 0; start < path.size();) {
+        // cesta delsi nez PATH_MAX se otevira po usecich na hranicich jmen
+        size_t end = path.size() - start <= limit ? path.size() : path.rfind('/', start + limit);
+        if (end == std::string::npos || end <= start) {
+            end = path.size();
+        }
+        int next = ::openat(fd, path.substr(start, end - start).c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd != root) {
+            ::close(fd);
+        }
+        if (next < 0) {
+            return -1;
+        }
+        fd = next;
+        start = end + 1;
+    }
+    return fd;
+}
+#endif
+
+// Vycet polozek slozky. Na Linuxu cte getdents64 velkym bufferem a typ bere z d_type bez dalsiho
+// dotazu; statx se vola jen pro DT_UNKNOWN a pro symbolicke odkazy (odkaz muze vest na slozku).
+// onEntry vraci false, kdyz se ma vycet prerusit.
+// withMetadata nacte i velikost a cas vsech polozek (razeni podle velikosti nebo casu).
+bool enumerateDirectory(const std::string& path, const std::function<bool(std::string_view, const EntryInfo&)>& onEntry,
+    std::string& error, bool withMetadata) {
+#ifdef __linux__
+    int dirfd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd < 0) {
+        error = std::string("Chyba pri cteni adresare: ") + std::strerror(errno);
+        return false;
+    }
+    std::vector<char> buffer(1 << 20); // 1 MiB na jedno volani, tisice polozek najednou
+    bool complete = true;
+    while (complete) {
+        long length = ::syscall(SYS_getdents64, dirfd, buffer.data(), buffer.size());
+        if (length <= 0) {
+            if (length < 0) {
+                error = std::string("Chyba pri cteni adresare: ") + std::strerror(errno);
+                complete = false;
+            }
+            break;
+        }
+        for (long offset = 0; offset < length && complete;) {
+            auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+            offset += dirent->d_reclen;
+            const char* name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+                continue;
+            }
+            EntryInfo info;
+            info.isSymlink = dirent->d_type == DT_LNK;
+            if (withMetadata || dirent->d_type == DT_UNKNOWN || dirent->d_type == DT_LNK) {
+                statEntry(dirfd, name, info);
+            }
+            else {
+                info.isDirectory = dirent->d_type == DT_DIR;
+            }
+            complete = onEntry(name, info);
+        }
+    }
+    ::close(dirfd);
+    return complete;
+#else
+    try {
+        for (const auto& entry : fs::directory_iterator(path)) {
+            EntryInfo info = loadInfo(entry); // Windows ma typ, velikost i cas uz z vyctu
+            info.isSymlink = entry.is_symlink();
+            if (!onEntry(entry.path().filename().string(), info)) {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        error = std::string("Chyba pri cteni adresare: ") + e.what();
+        return false;
+    }
+    return true;
+#endif
+}
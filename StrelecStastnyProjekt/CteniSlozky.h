@@ -0,0 +1,55 @@
+﻿// CteniSlozky.h: Vycet polozek slozky (getdents64 a statx na Linuxu) a otisk slozky
+// pro overeni seznamu ulozeneho v cache.
+
+#pragma once
+
+#include "TabulkaPolozek.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+// Otisk slozky pro overeni seznamu ulozeneho v cache: pridani, smazani i prejmenovani zmeni mtime a ctime
+struct DirectoryStamp {
+    std::int64_t mtime = 0;   // ns
+    std::int64_t ctime = 0;   // ns, meni se pri kazde zmene inode, i kdyz nekdo mtime vrati zpet
+    std::uint64_t inode = 0;
+    std::uint64_t links = 0;  // pocet podslozek + 2
+    std::int64_t takenAt = 0; // kdy byl otisk porizen, ns
+    bool valid = false;
+
+    static DirectoryStamp of(const std::string& path);
+    bool matches(const DirectoryStamp& now) const;
+};
+
+// Typ, velikost a cas polozky z directory_entry, cte se jednou pri obnoveni seznamu
+EntryInfo loadInfo(const fs::directory_entry& entry);
+
+#ifdef __linux__
+// linux_dirent64 z getdents64(2), glibc ho nezverejnuje
+struct LinuxDirent64 {
+    std::uint64_t d_ino;
+    std::int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// statx relativne k deskriptoru slozky; AT_STATX_DONT_SYNC, na NFS se nevynucuje obnova atributu
+bool statEntry(int dirfd, const char* name, EntryInfo& info);
+
+// Otevre slozku path (relativne k root, bez "/" na konci) bez nasledovani odkazu; cesta delsi nez
+// PATH_MAX se otevira po usecich. Vrati novy deskriptor, nebo -1 a errno.
+int openBelow(int root, const std::string& path);
+#endif
+
+// Vycet polozek slozky. Na Linuxu cte getdents64 velkym bufferem a typ bere z d_type bez dalsiho
+// dotazu; statx se vola jen pro DT_UNKNOWN a pro symbolicke odkazy (odkaz muze vest na slozku).
+// onEntry vraci false, kdyz se ma vycet prerusit.
+// withMetadata nacte i velikost a cas vsech polozek (razeni podle velikosti nebo casu).
+bool enumerateDirectory(const std::string& path, const std::function<bool(std::string_view, const EntryInfo&)>& onEntry,
+    std::string& error, bool withMetadata = false);
@@ -1,337 +1,341 @@
-﻿#include "FinalniProjektStrelecStastny.h"
-// CMakeProject16.cpp: Definuje vstupní bod pro aplikaci.
-//
-
-
-#include <iostream>
-#include <vector>
-#include <string>
-#include <set>
-#include <filesystem>
-#include <fstream>
-#include <iomanip>
-#include <chrono>
-#include <ctime>
-
-namespace fs = std::filesystem; // nadefinovani fs
-
-// Struktura pro reprezentaci schránky
-struct Clipboard {
-    std::set<fs::path> files; // unikatnost kazde slozky
-
-    void add(const fs::path& file) {
-        files.insert(file);
-    } // definice funkce add, zajisteni unikatnosti
-
-    void clear() {
-        files.clear();
-    }
-};          // definice funkce clear
-
-// Struktura pro reprezentaci panelu
-struct FilePanel {
-    std::string currentPath;
-    std::vector<fs::directory_entry> entries;   // definice vectoru entries, directory_entry je typ z knihovny filesystem
-    int selectedIndex;
-    std::set<fs::path> selectedFiles; // Soubory vybrané pro hromadné operace
-
-    FilePanel(const std::string& path) : currentPath(path), selectedIndex(0) {
-        refreshEntries();
-    }  // konstruktor, zacina jednotlivy panel, proto selectedindex 0, protoze prvni polozka v seznamu
-
-    void refreshEntries();
-    fs::directory_entry selectedEntry();
-    void navigateUp();//  klavesa w
-        void navigateDown(); // klavesa s
-        void enterDirectory(); // klavesa o
-        void goBack(); // klavesa p
-        void toggleSelection();   // soubor/slozka
-    void clearSelection();    // zruseni vyberu
-    void createNewFile();     // klavesa n
-    void createNewFolder();   // klavesa k
-    void deleteSelectedFile(); // klavesa l
-    void displayRow(size_t rowIndex, bool isActive, int width) const;
-    std::string getLastModifiedTime(const fs::path& path) const;
-    std::string getFileSizeOrDir(const fs::directory_entry& entry) const; // definice jednotlivych funkci
-};
-
-// implementace FilePanel
-void FilePanel::refreshEntries() {
-    entries.clear();
-    try {
-        for (const auto& entry : fs::directory_iterator(currentPath)) {
-            entries.push_back(entry);
-        }
-    }        // try vyzkousi tento kod
-    catch (const std::exception& e) {
-        std::cerr << "Chyba pri ctení adresare: " << e.what() << "\n";
-    }
-}      // kdyby nastala chyba
-
-fs::directory_entry FilePanel::selectedEntry() {
-    if (entries.empty()) return {};  // overuje zda je seznam entries prazdny
-    return entries[selectedIndex];
-} // kdyz prazdny vrati promenou selectedIndex    
-
-void FilePanel::navigateUp() {
-    if (selectedIndex > 0) {
-        --selectedIndex;
-    }
-} //snizeni promenne selectedindex o jedna, posun dolu
-
-void FilePanel::navigateDown() {
-    if (selectedIndex < entries.size() - 1) {
-        ++selectedIndex;
-    }// zvyseni promenne selectedIndex o jedna, posun nahoru
-}
-
-void FilePanel::enterDirectory() {
-    if (!entries.empty() && fs::is_directory(selectedEntry())) {
-        currentPath = selectedEntry().path().string();
-        selectedIndex = 0;
-        refreshEntries();
-        clearSelection();
-    } //vstoupeni do slozky, klavesa o
-}
-
-void FilePanel::goBack() {
-    if (currentPath != "/") {
-        currentPath = fs::path(currentPath).parent_path().string();
-        selectedIndex = 0;
-        refreshEntries();
-        clearSelection();
-    } // klavesa p, jit zpatky
-}
-
-void FilePanel::toggleSelection() {
-    if (!entries.empty()) {
-        fs::path filePath = selectedEntry().path();
-        if (selectedFiles.count(filePath)) {
-            selectedFiles.erase(filePath); // Zrušení výběru
-        }
-        else {
-            selectedFiles.insert(filePath); // Přidání do výběru
-        }
-    }
-}  // vyber jednotlivych souboru pro praci s nimi, klavesa m
-
-void FilePanel::clearSelection() {
-    selectedFiles.clear();
-} //odstraneni vsech vybranych souboru
-
-void FilePanel::createNewFile() {
-    std::cout << "Zadejte nazev noveho souboru: ";
-    std::string fileName;
-    std::cin >> fileName;
-    fs::path filePath = fs::path(currentPath) / fileName;
-    // vytvoreni noveho souboru, klavesa n
-    try {
-        std::ofstream(filePath.string()); // Vytvoří prázdný soubor
-        refreshEntries();
-        std::cout << "Soubor \"" << fileName << "\" vytvoren.\n";
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Chyba pri vytvareni souboru: " << e.what() << "\n"; // chyba pri vytvareni
-    }
-}
-
-void FilePanel::createNewFolder() {
-    std::cout << "Zadejte nazev nove slozky: ";
-    std::string folderName;
-    std::cin >> folderName;
-    fs::path folderPath = fs::path(currentPath) / folderName;       // vytvareni nove slozky, klavesa k
-
-    try {
-        fs::create_directory(folderPath); // Vytvoření složky
-        refreshEntries();
-
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Chyba pri vytvareni slozky: " << e.what() << "\n";
-    }
-}
-
-void FilePanel::deleteSelectedFile() {
-    if (entries.empty()) {
-        std::cout << "Zadny soubor k odstraneni.\n";
-        return;
-    }            // funkce na smazani souboru, klavesa l
-
-    fs::path filePath = selectedEntry().path();
-    std::cout << "Opravdu chcete smazat \"" << filePath.filename().string() << "\"? (y/n): ";
-    char confirmation;
-    std::cin >> confirmation;
-
-    if (confirmation == 'y' || confirmation == 'Y') {        //potvrzeni volby smazani
-        try {
-            if (fs::is_directory(filePath)) {
-                fs::remove_all(filePath); // Smaže složku a její obsah
-            }
-            else {
-                fs::remove(filePath); // Smaže soubor
-            }
-            refreshEntries(); // Aktualizuje obsah panelu
-            std::cout << "Soubor/slozka \"" << filePath.filename().string() << "\" odstranen(a).\n";
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Chyba pri odstranovani: " << e.what() << "\n";
-        }
-    }
-    else {
-        std::cout << "Odstraneni zruseno.\n";
-    }
-}
-
-std::string FilePanel::getLastModifiedTime(const fs::path& path) const {
-    try {
-        auto ftime = fs::last_write_time(path);
-        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-            ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-        std::time_t cftime = std::chrono::system_clock::to_time_t(sctp);
-        char buffer[20];
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", std::localtime(&cftime));
-        return std::string(buffer);
-    }
-    catch (...) {
-        return "N/A";
-    }
-}        // funkce na ziskavani casu posledni upravy
-
-std::string FilePanel::getFileSizeOrDir(const fs::directory_entry& entry) const {
-    if (fs::is_directory(entry)) {
-        return "DIR";
-    }
-    try {
-        auto size = fs::file_size(entry);
-        return std::to_string(size) + " B";
-    }
-    catch (...) {
-        return "N/A";
-    }
-} // funkce na ziskavani velikosti souboru ci slozky
-
-void FilePanel::displayRow(size_t rowIndex, bool isActive, int width) const {
-    if (rowIndex == 0) {
-        std::cout << (isActive ? ">>> " : "    ") << std::setw(width - 4) << std::left << currentPath;
-    }
-    else if (rowIndex - 1 < entries.size()) {
-        const auto& entry = entries[rowIndex - 1];
-        std::string name = entry.path().filename().string();
-        if (fs::is_directory(entry)) {
-            name += "/";
-        }
-        std::string sizeOrDir = getFileSizeOrDir(entry);
-        std::string modifiedTime = getLastModifiedTime(entry.path());
-
-        bool isSelected = selectedFiles.count(entry.path()) > 0;
-
-        std::cout << (rowIndex - 1 == selectedIndex ? " > " : "   ")
-            << (isSelected ? "*" : " ") // Označení vybraného souboru
-            << std::setw(width - 20) << name
-            << std::setw(12) << sizeOrDir
-            << modifiedTime;
-    }
-    else {
-        std::cout << std::setw(width) << " ";
-    }
-}  // struktura panelu
-
-// Funkce pro vyčištění konzole
-void clearScreen() {
-#ifdef _WIN32
-    system("cls");
-#else
-    system("clear");
-#endif
-}
-// Hlavní funkce
-int main() {
-    const int panelWidth = 60;  // Nastavuje konstantní šířku pro každý panel
-    FilePanel leftPanel("/"); // Levý a pravy panel zobrazující obsah kořenového adresáře ("/")
-    FilePanel rightPanel("/");
-    Clipboard clipboard; // Schránka pro kopírování souboru a složek
-    bool activeLeft = true; // definice proměnné bool pro navazující while
-
-    while (true) { //pokud je proměnná active=true
-        clearScreen();
-
-        std::cout << "=<=<=< Dvou-panelovy spravce souboru >=>=>=\n";
-        std::cout << "Ovladani pomoci funkcnich klaves: w/s (nahoru/dolu), a/d (prepnuti panelu), m (vybrat vice), "
-            "c (kopirovat), v (vlozit), n (novy soubor), k (nova slozka), l (smazat), "
-            "o (otevrit), p (zpet), q (konec)\n Pokyny k pouziti: Pred kazdym kopirovanim je nutne nejdrive soubor ci slozku oznacit klavesou m\n";
-
-        size_t maxRows = std::max(leftPanel.entries.size(), rightPanel.entries.size()) + 1; //nastavuje počet řádků potřebný pro zobrazení panelu +1
-
-        for (size_t i = 0; i < maxRows; ++i) {
-            leftPanel.displayRow(i, activeLeft, panelWidth);
-            std::cout << " | "; // panely jsou odděleny svislou čarou
-            rightPanel.displayRow(i, !activeLeft, panelWidth);
-            std::cout << "\n";
-        } //zobrazení obou panelů na jeden řádek
-
-        FilePanel& activePanel = activeLeft ? leftPanel : rightPanel; // indikator aktivniho panelu
-
-        char ch;
-        std::cin >> ch; //zadani funkcnich klaves
-
-        switch (ch) {
-        case 'w': // Nahoru
-            activePanel.navigateUp();
-            break;
-        case 's': // Dolů
-            activePanel.navigateDown();
-            break;
-        case 'a': // Přepnout na levý panel
-            activeLeft = true;
-            break;
-        case 'd': // Přepnout na pravý panel
-            activeLeft = false;
-            break;
-        case 'm': // Výběr více souborů
-            activePanel.toggleSelection();
-            break;
-        case 'c': // Kopírování
-            for (const auto& file : activePanel.selectedFiles) {
-                clipboard.add(file);
-            }
-            std::cout << "Vybrane polozky byly zkopirovany do schranky.\n";
-            break;
-        case 'v': // Vložení
-            for (const auto& file : clipboard.files) {
-                fs::path destination = fs::path(activePanel.currentPath) / file.filename();
-                try {
-                    fs::copy(file, destination, fs::copy_options::recursive);
-                }
-                catch (const std::exception& e) {
-                    std::cerr << "Chyba pri vkladani: " << e.what() << "\n";
-                }
-            }
-            clipboard.clear();
-            activePanel.refreshEntries();
-            break;
-        case 'n': // Nový soubor
-            activePanel.createNewFile();
-            break;
-        case 'k': // Nová složka
-            activePanel.createNewFolder();
-            break;
-        case 'l': // Smazání souboru
-            activePanel.deleteSelectedFile();
-            break;
-        case 'o': // Otevřít složku
-            activePanel.enterDirectory();
-            break;
-        case 'p': // Zpět
-            activePanel.goBack();
-            break;
-        case 'q': // Ukončit program
-            return 0;
-        default:
-            std::cout << "Neplatna volba.\n";
-        }
-    }
-}
-
- 
-
- 
+﻿#include "FinalniProjektStrelecStastny.h"
+// CMakeProject16.cpp: Definuje vstupní bod pro aplikaci.
+//
+// Casti spravce jsou v dvojicich .h/.cpp (Panel, Hledani, Ulohy, Kos, Terminal, ...), zde je jen hlavni smycka.
+
+#include "Schranka.h"
+#include "Formatovani.h"
+#include "Panel.h"
+#include "PocitadloDotazu.h"
+#include "Hledani.h"
+#include "VelikostiSlozek.h"
+#include "Ulohy.h"
+#include "Kos.h"
+#include "Terminal.h"
+#include "Vykreslovani.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <ctime>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <limits>
+
+namespace fs = std::filesystem; // nadefinovani fs
+
+// Hlavní funkce
+int main() {
+    const int panelWidth = 60;  // Nastavuje konstantní šířku pro každý panel
+    FilePanel leftPanel("/"); // Levý a pravy panel zobrazující obsah kořenového adresáře ("/")
+    FilePanel rightPanel("/");
+    Clipboard clipboard; // Schránka pro kopírování souboru a složek
+    bool activeLeft = true; // definice proměnné bool pro navazující while
+    TerminalRenderer renderer; // vykreslovani bez mazani cele obrazovky
+    std::vector<std::string> frame; // radky snimku; retezce se mezi snimky nemazou, jejich pamet se pouzije znovu
+    size_t frameLines = 0;
+    auto nextLine = [&]() -> std::string& {
+        if (frameLines == frame.size()) {
+            frame.emplace_back();
+        }
+        std::string& line = frame[frameLines++];
+        line.clear();
+        return line;
+    };
+    ColumnFormatter columns; // sloupce velikosti a casu, sdilene obema panely
+    std::string message; // hlaska pod panely, napr. vysledek vlozeni
+    bool filterMode = false; // znaky se pripisuji do filtru aktivniho panelu
+    JobQueue jobs; // kopirovani, presun a mazani bezi na pozadi
+    Trash trash; // l presouva do kose, stare polozky se cisti na pozadi
+    DirectorySizes directorySizes(std::max(2u, std::thread::hardware_concurrency())); // sloupec velikosti u slozek
+    TerminalInput input; // klavesy bez Enteru, sipky a PgUp/PgDn/Home/End
+    size_t pageRows = 1; // radku panelu v minulem snimku, o tolik posune PgUp/PgDn
+    unsigned promptsDrawn = 0; // dotazy, po kterych uz se obrazovka prekreslila
+    const bool errorsToLog = !stderrIsTerminal(); // 2>soubor dostane vsechny chyby, obrazovka jen prvni
+
+    while (true) { //pokud je proměnná active=true
+        for (FilePanel* panel : { &leftPanel, &rightPanel }) {
+            panel->pollScan(); // postupne nacitana slozka
+            panel->applyWatchEvents(); // zmeny od uloh i od jinych programu
+        }
+        for (const auto& dir : jobs.takeChangedDirs()) { // prubezne obnoveni panelu podle bezicich uloh
+            for (FilePanel* panel : { &leftPanel, &rightPanel }) {
+                if (!panel->watcher.active() && panel->searchText.empty() && fs::path(panel->currentPath) == fs::path(dir)) {
+                    panel->refreshEntries(); // jen kdyz slozku nehlida inotify
+                }
+            }
+        }
+        for (const auto& job : jobs.takeFinished()) {
+            message = job->statusLine() + (job->progress.cancelled ? " - zruseno" : " - hotovo")
+                + (job->methods.empty() ? "" : " (" + job->methods + ")")
+                + ", chyb: " + std::to_string(job->errors.size());
+            for (const auto& error : job->errors) {
+                if (errorsToLog) {
+                    std::cerr << "Chyba: " << error << "\n";
+                }
+            }
+            if (!job->errors.empty()) {
+                message += " - prvni: " + job->errors.front();
+            }
+        }
+
+        frameLines = 0;
+        nextLine() = "=<=<=< Dvou-panelovy spravce souboru >=>=>=";
+        nextLine() = "Ovladani pomoci funkcnich klaves: w/s nebo sipky (nahoru/dolu), PgUp/PgDn/Home/End, a/d (prepnuti panelu), m (vybrat vice), c (kopirovat), v (vlozit),";
+        nextLine() = "n (novy soubor), k (nova slozka), l (do kose), L (smazat), b (obnovit), o (otevrit), p (zpet), x (vyjmout), u (pauza ulohy), z (zrusit ulohu),";
+        nextLine() = "t (zpusob razeni), r (obratit razeni), / (filtr), f (hledat), g (hledat text), M/A/*/+ (oznacit rozsah/vse/obratit/podle vzoru),";
+        nextLine() = "h (velikosti v KiB/MiB), T (relativni cas), q (konec)";
+        nextLine() = " Pokyny k pouziti: Pred kazdym kopirovanim je nutne nejdrive soubor ci slozku oznacit klavesou m";
+        std::string& counters = nextLine();
+        counters = "Dotazy na souborovy system od minuleho snimku: ";
+        appendNumber(counters, fsCalls.load());
+        counters += "   Bajtu na terminal minule: ";
+        appendNumber(counters, renderer.lastBytes);
+        fsCalls = 0; // pocitadlo se nuluje kazdy snimek
+
+        int termRows, termCols;
+        terminalSize(termRows, termCols);
+        std::vector<std::string> jobLines; // stavove radky bezicich uloh
+        {
+            std::lock_guard<std::mutex> lock(jobs.mutex);
+            for (const auto& job : jobs.jobs) {
+                jobLines.push_back(job->statusLine());
+            }
+        }
+        // hlavicka s legendou, radek s cestou, stavove radky uloh, radek pro hlasky a radek pro zadani klavesy
+        int reservedRows = static_cast<int>(frameLines + jobLines.size()) + 3;
+        size_t visibleRows = static_cast<size_t>(std::max(termRows - reservedRows, 1));
+        pageRows = visibleRows;
+        for (FilePanel* panel : { &leftPanel, &rightPanel }) {
+            panel->scrollToSelection(visibleRows);
+            panel->ensureMetadata(panel->scrollOffset, panel->scrollOffset + visibleRows); // stat jen pro zobrazene radky
+            panel->updateDirectorySizes(directorySizes, panel->scrollOffset, panel->scrollOffset + visibleRows);
+        }
+        size_t maxRows = std::min(std::max(leftPanel.visible().size(), rightPanel.visible().size()), visibleRows) + 1; //vykresli se jen radky, ktere se vejdou do terminalu, +1 pro cestu
+
+        columns.now = std::time(nullptr);
+        for (size_t i = 0; i < maxRows; ++i) {
+            std::string& row = nextLine();
+            leftPanel.displayRow(row, i, activeLeft, panelWidth, columns);
+            row += " | "; // panely jsou odděleny svislou čarou
+            rightPanel.displayRow(row, i, !activeLeft, panelWidth, columns);
+        } //zobrazení obou panelů na jeden řádek
+        for (const auto& line : jobLines) {
+            nextLine() = line;
+        }
+        nextLine() = filterMode ? "Filtr (Enter potvrdi, Esc zrusi): " + (activeLeft ? leftPanel : rightPanel).filter + "_" : message;
+        frame.resize(frameLines);
+        if (input.prompts != promptsDrawn) {
+            renderer.invalidate(); // dotaz a odpoved posunuly obrazovku
+            promptsDrawn = input.prompts;
+        }
+        renderer.render(frame);
+
+        // bezi-li ulohy, prubeh se prekresluje i bez stisku klavesy; zmena ve slozce panel obnovi hned
+        // pri nacitani slozky se prekresluje casteji, aby prvni obrazovka byla videt hned
+        bool scanning = leftPanel.loading() || rightPanel.loading();
+        if (input.pending.empty() && !waitForInput(scanning ? 50 : (jobLines.empty() && !directorySizes.busy()) ? -1 : 250,
+            { leftPanel.loading() ? -1 : leftPanel.watcher.fd, rightPanel.loading() ? -1 : rightPanel.watcher.fd })) {
+            continue;
+        }
+        message.clear();
+
+        FilePanel& activePanel = activeLeft ? leftPanel : rightPanel; // indikator aktivniho panelu
+
+        if (input.pending.empty() && !input.read(filterMode)) {
+            return 0; // konec vstupu
+        }
+
+        if (!filterMode && TerminalInput::isNavigation(input.pending.front())) {
+            // drzena klavesa posle desitky znaku za snimek: vsechny prectene posuny se provedou naraz
+            // a kresli se az vysledna poloha, ne kazdy mezikrok
+            while (!input.pending.empty() && TerminalInput::isNavigation(input.pending.front())) {
+                switch (input.pending.front()) {
+                case 'w': case TerminalInput::Up: activePanel.moveCursor(-1); break;
+                case 's': case TerminalInput::Down: activePanel.moveCursor(1); break;
+                case TerminalInput::PageUp: activePanel.moveCursor(-static_cast<std::int64_t>(pageRows)); break;
+                case TerminalInput::PageDown: activePanel.moveCursor(static_cast<std::int64_t>(pageRows)); break;
+                case TerminalInput::Home: activePanel.moveCursor(std::numeric_limits<int>::min()); break;
+                case TerminalInput::End: activePanel.moveCursor(std::numeric_limits<int>::max()); break;
+                }
+                input.pending.pop_front();
+            }
+            continue;
+        }
+        int ch = input.pending.front();
+        input.pending.pop_front();
+
+        if (filterMode) { // kazdy znak zuzi vysledek, Enter a mezery se musi videt
+            if (ch == '\n' || ch == '\r') {
+                filterMode = false; // filtr zustane aktivni
+            }
+            else if (ch == 27) { // Esc
+                activePanel.clearFilter();
+                filterMode = false;
+            }
+            else if (ch == 127 || ch == 8) { // Backspace
+                activePanel.popFilter();
+            }
+            else if (ch >= ' ' && ch < 0x100) {
+                activePanel.appendFilter(static_cast<char>(ch));
+            }
+            continue;
+        }
+
+        switch (ch) {
+        case 'a': // Přepnout na levý panel
+            activeLeft = true;
+            break;
+        case 'd': // Přepnout na pravý panel
+            activeLeft = false;
+            break;
+        case 'm': // Výběr více souborů
+            activePanel.toggleSelection();
+            break;
+        case 'M': // Oznaceni rozsahu od posledniho m po kurzor
+            activePanel.selectRange();
+            break;
+        case 'A': // Oznaceni vseho zobrazeneho
+            activePanel.selectAll();
+            break;
+        case '*': // Obraceni vyberu
+            activePanel.invertSelection();
+            break;
+        case '+': { // Oznaceni podle vzoru, velikosti nebo casu zmeny
+            TerminalInput::LineMode lineMode(input);
+            std::cout << "Oznacit (vzor, -size [+-]N[kMG], -mtime [+-]dny): ";
+            std::string text;
+            std::getline(std::cin >> std::ws, text);
+            FindQuery query;
+            std::string error;
+            if (!query.parse(text, error)) {
+                message = error;
+            }
+            else {
+                activePanel.selectMatching(query);
+                message = "Oznaceno polozek: " + std::to_string(activePanel.selectedCount);
+            }
+            break;
+        }
+        case 'c': // Kopírování
+            if (clipboard.cut) {
+                clipboard.clear(); // vyjmute polozky se kopirovanim nahradi
+            }
+            activePanel.forEachSelected([&](size_t i) { clipboard.add(activePanel.currentPath, activePanel.entryPath(i)); });
+            message = "Vybrane polozky byly zkopirovany do schranky.";
+            break;
+        case 'v': // Vložení, kopiruje nebo presouva se na pozadi
+            if (!clipboard.empty()) {
+                jobs.submit(clipboard.cut ? Job::Kind::Move : Job::Kind::Copy, clipboard.paths(), activePanel.currentPath);
+            }
+            clipboard.clear();
+            break;
+        case 'x': // Vyjmutí, pri vlozeni se polozky presunou
+            clipboard.clear();
+            activePanel.forEachSelected([&](size_t i) { clipboard.add(activePanel.currentPath, activePanel.entryPath(i)); });
+            clipboard.cut = true;
+            activePanel.clearSelection();
+            break;
+        case 'u': // Pozastavení / pokračování poslední úlohy
+            if (auto job = jobs.newestActive()) {
+                job->progress.setPaused(!job->progress.paused);
+            }
+            break;
+        case 'z': // Zrušení poslední úlohy
+            if (auto job = jobs.newestActive()) {
+                job->progress.cancel();
+            }
+            break;
+        case '/': // Filtr podle casti jmena
+            activePanel.clearFilter();
+            filterMode = true;
+            break;
+        case 27: // Esc zastavi hledani, jinak zrusi filtr
+            if (activePanel.loading() && !activePanel.searchText.empty()) {
+                activePanel.cancelScan();
+            }
+            else {
+                activePanel.clearFilter();
+            }
+            break;
+        case 'g': { // Hledani textu v oznacenych souborech nebo v podslozkach
+            TerminalInput::LineMode lineMode(input);
+            std::cout << "Hledat text v souborech: ";
+            std::string text;
+            std::getline(std::cin >> std::ws, text);
+            if (!text.empty()) {
+                activePanel.startGrep(text);
+            }
+            break;
+        }
+        case 'f': { // Hledani v podslozkach
+            TerminalInput::LineMode lineMode(input);
+            std::cout << "Hledat (vzor, -size [+-]N[kMG], -mtime [+-]dny): ";
+            std::string text;
+            std::getline(std::cin >> std::ws, text);
+            FindQuery query;
+            std::string error;
+            if (!query.parse(text, error)) {
+                message = error;
+            }
+            else {
+                activePanel.startFind(query, text);
+            }
+            break;
+        }
+        case 't': // Dalsi zpusob razeni: jmeno, prirozene, velikost, cas, pripona
+            activePanel.setSortMode(static_cast<FilePanel::SortMode>((static_cast<int>(activePanel.sortMode) + 1) % 5),
+                activePanel.sortDescending);
+            message = std::string("Razeni: ") + activePanel.sortModeName();
+            break;
+        case 'r': // Obracene razeni
+            activePanel.setSortMode(activePanel.sortMode, !activePanel.sortDescending);
+            break;
+        case 'h': // Velikosti v bajtech nebo KiB/MiB/GiB
+            columns.humanSizes = !columns.humanSizes;
+            break;
+        case 'T': // Cas zmeny jako datum nebo "pred 5 min"
+            columns.relativeTimes = !columns.relativeTimes;
+            break;
+        case 'n': { // Nový soubor
+            TerminalInput::LineMode lineMode(input);
+            activePanel.createNewFile(message);
+            break;
+        }
+        case 'k': { // Nová složka
+            TerminalInput::LineMode lineMode(input);
+            activePanel.createNewFolder(message);
+            break;
+        }
+        case 'l': { // Presun do kose, okamzity a vratny
+            TerminalInput::LineMode lineMode(input); // kdyz kos nejde pouzit, pta se na trvale smazani
+            activePanel.trashSelected(trash, jobs, message);
+            break;
+        }
+        case 'L': { // Trvalé smazání souboru
+            TerminalInput::LineMode lineMode(input);
+            activePanel.deleteSelectedFile(jobs, message);
+            break;
+        }
+        case 'b': // Obnoveni z kose
+            activePanel.restoreFromTrash(trash, message);
+            break;
+        case 'o': // Otevřít složku
+        case TerminalInput::Right:
+            activePanel.enterDirectory();
+            break;
+        case 'p': // Zpět
+        case TerminalInput::Left:
+            activePanel.goBack();
+            break;
+        case 'q': // Ukončit program
+            return 0;
+        default:
+            message = "Neplatna volba.";
+        }
+    }
+}
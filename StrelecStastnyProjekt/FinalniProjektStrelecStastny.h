@@ -1,8 +1,8 @@
-﻿// CMakeProject16.h: Soubor k zahrnutí pro standardní systémové soubory k zahrnutí
-// nebo soubory k zahrnutí specifické pro projekt.
-
-#pragma once
-
-#include <iostream>
-
-// TODO: Zde odkažte na dodatečné hlavičky, které program vyžaduje.
+﻿// CMakeProject16.h: Soubor k zahrnutí pro standardní systémové soubory k zahrnutí
+// nebo soubory k zahrnutí specifické pro projekt.
+
+#pragma once
+
+#include <iostream>
+
+// TODO: Zde odkažte na dodatečné hlavičky, které program vyžaduje.
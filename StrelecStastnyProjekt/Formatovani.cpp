@@ -0,0 +1,147 @@
+﻿// Formatovani.cpp: Cisla, zarovnani a sloupce velikosti a casu, viz Formatovani.h
+
+#include "Formatovani.h"
+
+#include <algorithm>
+
+void appendNumber(std::string& out, std::uint64_t value) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    out.append(p, digits + sizeof(digits));
+}
+
+void padTo(std::string& out, size_t start, size_t width) {
+    if (out.size() < start + width) {
+        out.append(start + width - out.size(), ' ');
+    }
+}
+
+void replaceControlBytes(std::string& text, size_t from) {
+    for (size_t i = from; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < ' ' || c == 0x7f) {
+            text[i] = '?';
+        }
+        else if (c == 0xC2 && i + 1 < text.size() && (static_cast<unsigned char>(text[i + 1]) & 0xE0) == 0x80) {
+            text.replace(i, 2, 1, '?');
+        }
+    }
+}
+
+// den od 1970-01-01 -> obcanske datum a zpet (H. Hinnant), bez tabulek a bez volani knihovny
+static std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+static void civilFromDays(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+std::int64_t ColumnFormatter::localOffset(std::time_t t) {
+    const std::tm* local = std::localtime(&t);
+    if (!local) {
+        return 0;
+    }
+    return daysFromCivil(local->tm_year + 1900, static_cast<unsigned>(local->tm_mon + 1), static_cast<unsigned>(local->tm_mday)) * 86400
+        + local->tm_hour * 3600 + local->tm_min * 60 + local->tm_sec - static_cast<std::int64_t>(t);
+}
+
+std::int64_t ColumnFormatter::offsetAt(std::time_t t) {
+    std::int64_t day = (t >= 0 ? t : t - 86399) / 86400;
+    OffsetSlot& slot = offsets[day & 63];
+    if (slot.day != day) {
+        slot.day = day;
+        slot.offset = localOffset(static_cast<std::time_t>(day * 86400));
+        slot.uniform = slot.offset == localOffset(static_cast<std::time_t>(day * 86400 + 86399));
+    }
+    return slot.uniform ? slot.offset : localOffset(t);
+}
+
+void ColumnFormatter::appendSize(std::string& out, const EntryInfo& info) const {
+    static const char* units[] = { " B", " KiB", " MiB", " GiB", " TiB", " PiB", " EiB" };
+    size_t start = out.size();
+    if (info.isDirectory && !info.sizeKnown) {
+        out += "DIR"; // velikost se jeste pocita
+    }
+    else if (!info.sizeKnown) {
+        out += "N/A";
+    }
+    else if (!humanSizes && info.size < (info.sizePartial ? 1000000000ull : 10000000000ull)) { // bajty, dokud se vejdou do sloupce
+        if (info.sizePartial) {
+            out += '>'; // nektere podslozky nesly otevrit, skutecna velikost je vetsi
+        }
+        appendNumber(out, info.size);
+        out += units[0];
+    }
+    else {
+        if (info.sizePartial) {
+            out += '>';
+        }
+        int unit = 0;
+        while (unit < 6 && info.size >> (10 * (unit + 1))) {
+            ++unit;
+        }
+        appendNumber(out, info.size >> (10 * unit));
+        if (unit) {
+            out += '.';
+            out += static_cast<char>('0' + ((info.size >> (10 * (unit - 1))) & 1023) * 10 / 1024); // desetiny dolu
+        }
+        out += units[unit];
+    }
+    padTo(out, start, sizeWidth);
+}
+
+void ColumnFormatter::appendTime(std::string& out, const EntryInfo& info) {
+    size_t start = out.size();
+    std::int64_t t = info.modified;
+    if (!info.timeKnown) {
+        out += "N/A";
+    }
+    else if (relativeTimes && now >= t && now - t < 30 * 86400) {
+        std::int64_t age = now - t;
+        if (age < 60) {
+            out += "prave ted";
+        }
+        else {
+            out += "pred ";
+            appendNumber(out, static_cast<std::uint64_t>(age < 3600 ? age / 60 : age < 86400 ? age / 3600 : age / 86400));
+            out += age < 3600 ? " min" : age < 86400 ? " h" : " d";
+        }
+    }
+    else {
+        std::int64_t local = t + offsetAt(static_cast<std::time_t>(t));
+        std::int64_t day = (local >= 0 ? local : local - 86399) / 86400;
+        if (day != cachedDay) {
+            std::int64_t y;
+            unsigned m, d;
+            civilFromDays(day, y, m, d);
+            y = std::max<std::int64_t>(0, std::min<std::int64_t>(9999, y));
+            char text[] = { char('0' + y / 1000), char('0' + y / 100 % 10), char('0' + y / 10 % 10), char('0' + y % 10), '-',
+                char('0' + m / 10), char('0' + m % 10), '-', char('0' + d / 10), char('0' + d % 10) };
+            std::copy(text, text + sizeof(text), dayText);
+            cachedDay = day;
+        }
+        std::int64_t minutes = (local - day * 86400) / 60;
+        out.append(dayText, sizeof(dayText));
+        char clock[] = { ' ', char('0' + minutes / 600), char('0' + minutes / 60 % 10), ':', char('0' + minutes % 60 / 10), char('0' + minutes % 10) };
+        out.append(clock, sizeof(clock));
+    }
+    padTo(out, start, timeWidth);
+}
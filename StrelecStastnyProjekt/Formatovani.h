@@ -0,0 +1,49 @@
+﻿// Formatovani.h: Skladani radku obrazovky bez zbytecnych alokaci: cisla, zarovnani,
+// sloupce velikosti a casu.
+
+#pragma once
+
+#include "TabulkaPolozek.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+// cislo do retezce bez docasneho std::string (std::to_string alokuje)
+void appendNumber(std::string& out, std::uint64_t value);
+
+// doplni radek mezerami od pozice start na sirku width (jako std::setw se zarovnanim vlevo)
+void padTo(std::string& out, size_t start, size_t width);
+
+// ridici znaky (i C1 v UTF-8, napr. U+009B) ze jmen souboru by terminal provedl jako prikaz,
+// nahradi se otaznikem jako v ls
+void replaceControlBytes(std::string& text, size_t from = 0);
+
+// Sloupce velikosti a casu zapsane primo do radku pevnou sirkou, bez alokaci na radek.
+// Posun casoveho pasma se pamatuje pro den UTC (localtime jen pri prvnim casu z toho dne)
+// a text data se pro casy z tehoz mistniho dne sklada jen jednou.
+struct ColumnFormatter {
+    static constexpr size_t sizeWidth = 12; // "1234567890 B", "12.3 MiB"
+    static constexpr size_t timeWidth = 16; // "2024-05-01 13:45"
+
+    bool humanSizes = false;    // klavesa h: KiB/MiB/GiB misto bajtu
+    bool relativeTimes = false; // klavesa T: "pred 5 min", starsi nez mesic jako datum
+    std::time_t now = 0;        // pro relativni cas, nastavuje se jednou za snimek
+
+    void appendSize(std::string& out, const EntryInfo& info) const;
+    void appendTime(std::string& out, const EntryInfo& info);
+
+private:
+    struct OffsetSlot {
+        std::int64_t day = INT64_MIN;
+        std::int64_t offset = 0;
+        bool uniform = false; // stejny posun cely den, jinak se v nem meni letni cas
+    };
+    OffsetSlot offsets[64];    // primo mapovana cache: den UTC -> posun mistniho casu v sekundach
+    std::int64_t cachedDay = INT64_MIN; // mistni den, jehoz datum je v dayText
+    char dayText[10] = {};
+
+    static std::int64_t localOffset(std::time_t t);
+    std::int64_t offsetAt(std::time_t t);
+};
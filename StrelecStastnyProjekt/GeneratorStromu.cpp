@@ -0,0 +1,408 @@
+﻿// GeneratorStromu.cpp: Vytvari umele stromy slozek pro zatezove testy spravce souboru.
+//
+// Pouziti: GeneratorStromu <cil> <specifikace>
+//   Specifikace je seznam casti oddelenych carkou, pocty mohou mit priponu k nebo M (tisice, miliony):
+//     ploche=N    N prazdnych souboru v jedne slozce (ploche/)
+//     smisene=N   N souboru po tisici ve slozkach, vetsinou male, petina do 256 KiB, kazdy sty 1-16 MiB
+//     ridke=N     N ridkych souboru o zdanlive velikosti 1-4 GiB s jednim zapsanym blokem
+//     retez=N     retez N vnorenych slozek, v kazde jeden soubor
+//     odkazy=N    N symbolickych odkazu, kazdy padesaty vede na neexistujici soubor
+//     pevne=N     N pevnych odkazu na desetinu tolika souboru
+//     seed=S      pocatecni hodnota nahodnych velikosti, jmen a casu (vychozi 1)
+//     vlakna=T    pocet vlaken (vychozi pocet jader)
+//   Priklad: GeneratorStromu /tmp/zatez ploche=1M,smisene=10k,ridke=100,retez=2000,odkazy=1k,pevne=1k,seed=42
+//
+// Stejna specifikace vytvori vzdy stejny strom (jmena, velikosti i casy zmeny), nezavisle na poctu
+// vlaken: vse se odvozuje z hashe (seed, cast, poradi), ne z poradi, v jakem vlakna praci dostanou.
+// Lisit se muze jen velikost samotnych slozek, tu urcuje souborovy system podle poradi vkladani.
+// Soubory se zakladaji pres openat vuci jednou otevrene slozce a misto zapisu dat se jim bloky
+// prideli pres fallocate.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// splitmix64: z jednoho cisla rychle a rovnomerne dalsi, bez sdileneho stavu mezi vlakny
+static std::uint64_t mix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// nahodna hodnota polozky index v casti part, pro salt ruzne vlastnosti (velikost, cas, ...)
+static std::uint64_t valueFor(std::uint64_t seed, int part, std::uint64_t index, int salt) {
+    return mix(mix(mix(seed ^ static_cast<std::uint64_t>(part)) + index) + static_cast<std::uint64_t>(salt));
+}
+
+enum Part { Flat, Mixed, Sparse, Chain, Symlinks, Hardlinks, PartCount };
+static const char* const partNames[PartCount] = { "ploche", "smisene", "ridke", "retez", "odkazy", "pevne" };
+
+struct Spec {
+    std::uint64_t counts[PartCount] = {};
+    std::uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    bool parse(const std::string& text, std::string& error);
+};
+
+bool Spec::parse(const std::string& text, std::string& error) {
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(start, end - start);
+        start = end + 1;
+        if (item.empty()) {
+            continue;
+        }
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            error = "chybi '=' v \"" + item + "\"";
+            return false;
+        }
+        std::string key = item.substr(0, equals);
+        std::string number = item.substr(equals + 1);
+        std::uint64_t multiplier = 1;
+        if (!number.empty() && (number.back() == 'k' || number.back() == 'M')) {
+            multiplier = number.back() == 'k' ? 1000 : 1000000;
+            number.pop_back();
+        }
+        char* rest = nullptr;
+        errno = 0;
+        std::uint64_t value = std::strtoull(number.c_str(), &rest, 10);
+        if (number.empty() || *rest != '\0' || errno != 0) {
+            error = "neplatne cislo v \"" + item + "\"";
+            return false;
+        }
+        value *= multiplier;
+        if (key == "seed") {
+            seed = value;
+            continue;
+        }
+        if (key == "vlakna") {
+            threads = static_cast<unsigned>(std::max<std::uint64_t>(value, 1));
+            continue;
+        }
+        int part = 0;
+        while (part < PartCount && key != partNames[part]) {
+            ++part;
+        }
+        if (part == PartCount) {
+            error = "neznama cast \"" + key + "\"";
+            return false;
+        }
+        counts[part] = value;
+    }
+    return true;
+}
+
+// Jeden kus prace pro vlakno: rozsah polozek jedne casti, ktere lezi ve stejne slozce
+struct Chunk {
+    int part;
+    std::string dir;       // relativne k cili
+    std::uint64_t first;
+    std::uint64_t last;
+    bool links;            // druha faze: odkazy az po vytvoreni cilu
+};
+
+struct Totals {
+    std::atomic<std::uint64_t> files{ 0 };
+    std::atomic<std::uint64_t> links{ 0 };
+    std::atomic<std::uint64_t> allocated{ 0 }; // bajtu pridelenych pres fallocate nebo zapsanych
+    std::atomic<std::uint64_t> errors{ 0 };
+};
+
+class Generator {
+public:
+    Generator(int rootFd, const Spec& spec) : rootFd(rootFd), spec(spec) {}
+
+    void run();
+    Totals totals;
+
+private:
+    static constexpr std::uint64_t filesPerDir = 1000;  // smisene a cile odkazu
+    static constexpr std::uint64_t chunkSize = 4096;    // polozek na jeden kus prace ve velke slozce
+    static constexpr std::int64_t baseTime = 1577836800; // 2020-01-01, casy zmeny do peti let pozdeji
+
+    int rootFd;
+    const Spec& spec;
+    std::vector<std::string> directories; // v poradi zalozeni, casy se jim nastavi az na konci
+
+    void setTimes(timespec times[2], int part, std::uint64_t index) const;
+    void makeDirectory(const std::string& path);
+    void plan(std::vector<Chunk>& files, std::vector<Chunk>& links);
+    void runChunks(const std::vector<Chunk>& chunks);
+    void runChunk(const Chunk& chunk);
+    void createChain();
+    bool createFile(int dirFd, const char* name, std::uint64_t size, int part, std::uint64_t index, bool sparse);
+    void fail(const std::string& what);
+};
+
+void Generator::fail(const std::string& what) {
+    if (totals.errors++ < 10) { // pri plnem disku by se jinak vypsal kazdy soubor
+        std::cerr << what << ": " << std::strerror(errno) << "\n";
+    }
+}
+
+// cas zmeny je soucasti specifikace, ne okamziku vytvoreni
+void Generator::setTimes(timespec times[2], int part, std::uint64_t index) const {
+    times[0].tv_sec = times[1].tv_sec = baseTime + static_cast<std::int64_t>(valueFor(spec.seed, part, index, 2) % (5 * 365 * 86400ULL));
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+}
+
+void Generator::makeDirectory(const std::string& path) {
+    if (::mkdirat(rootFd, path.c_str(), 0755) != 0 && errno != EEXIST) {
+        fail("mkdir " + path);
+    }
+    directories.push_back(path);
+}
+
+// rozdeli praci na kusy, kazdy kus lezi v jedne slozce, takze vlakno si ji otevre jen jednou
+void Generator::plan(std::vector<Chunk>& files, std::vector<Chunk>& links) {
+    char dir[64];
+    auto split = [&](std::vector<Chunk>& out, int part, const std::string& path, std::uint64_t first, std::uint64_t last, bool isLink) {
+        for (std::uint64_t from = first; from < last; from += chunkSize) {
+            out.push_back({ part, path, from, std::min(last, from + chunkSize), isLink });
+        }
+    };
+    if (spec.counts[Flat]) {
+        makeDirectory("ploche");
+        split(files, Flat, "ploche", 0, spec.counts[Flat], false);
+    }
+    if (spec.counts[Mixed]) {
+        makeDirectory("smisene");
+        for (std::uint64_t first = 0; first < spec.counts[Mixed]; first += filesPerDir) {
+            std::snprintf(dir, sizeof(dir), "smisene/s%05llu", static_cast<unsigned long long>(first / filesPerDir));
+            makeDirectory(dir);
+            split(files, Mixed, dir, first, std::min(spec.counts[Mixed], first + filesPerDir), false);
+        }
+    }
+    if (spec.counts[Sparse]) {
+        makeDirectory("ridke");
+        split(files, Sparse, "ridke", 0, spec.counts[Sparse], false);
+    }
+    for (int part : { Symlinks, Hardlinks }) {
+        if (!spec.counts[part]) {
+            continue;
+        }
+        makeDirectory(partNames[part]);
+        std::string targets = std::string(partNames[part]) + "/cile";
+        makeDirectory(targets);
+        split(files, part, targets, 0, spec.counts[part] / 10 + 1, false); // cile odkazu
+        split(links, part, partNames[part], 0, spec.counts[part], true);
+    }
+}
+
+// vytvori soubor a prideli mu bloky
+bool Generator::createFile(int dirFd, const char* name, std::uint64_t size, int part, std::uint64_t index, bool sparse) {
+    int fd = ::openat(dirFd, name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fail(std::string("open ") + name);
+        return false;
+    }
+    bool ok = true;
+    if (sparse) {
+        // zdanliva velikost bez bloku, jeden blok dat na nahodnem miste
+        std::uint64_t offset = valueFor(spec.seed, part, index, 3) % (size / 4096) * 4096;
+        static const char block[4096] = { 'x' };
+        ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0
+            && ::pwrite(fd, block, sizeof(block), static_cast<off_t>(offset)) == static_cast<ssize_t>(sizeof(block));
+        totals.allocated += sizeof(block);
+    }
+    else if (size > 0) {
+        if (::fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0) {
+            totals.allocated += size;
+        }
+        else { // souborovy system bez fallocate: aspon spravna velikost
+            ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        }
+    }
+    timespec times[2];
+    setTimes(times, part, index);
+    ok = ::futimens(fd, times) == 0 && ok;
+    if (!ok) {
+        fail(std::string("fallocate ") + name);
+    }
+    ::close(fd);
+    ++totals.files;
+    return ok;
+}
+
+void Generator::runChunk(const Chunk& chunk) {
+    int dirFd = ::openat(rootFd, chunk.dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        fail("open " + chunk.dir);
+        return;
+    }
+    static const char* const extensions[] = { "txt", "log", "jpg", "dat", "cpp", "pdf", "tar.gz", "md" };
+    char name[64];
+    char target[64];
+    for (std::uint64_t i = chunk.first; i < chunk.last; ++i) {
+        unsigned long long n = i;
+        std::uint64_t random = valueFor(spec.seed, chunk.part, i, 1);
+        if (chunk.links) {
+            unsigned long long targetIndex = random % (spec.counts[chunk.part] / 10 + 1);
+            std::snprintf(name, sizeof(name), "odkaz%07llu", n);
+            if (chunk.part == Symlinks) {
+                std::snprintf(target, sizeof(target), random % 50 == 0 ? "cile/chybi%06llu" : "cile/cil%06llu.txt", targetIndex);
+                timespec times[2];
+                setTimes(times, chunk.part, i);
+                if (::symlinkat(target, dirFd, name) != 0 || ::utimensat(dirFd, name, times, AT_SYMLINK_NOFOLLOW) != 0) {
+                    fail(std::string("symlink ") + name);
+                }
+            }
+            else {
+                std::snprintf(target, sizeof(target), "cile/cil%06llu.txt", targetIndex);
+                if (::linkat(dirFd, target, dirFd, name, 0) != 0) {
+                    fail(std::string("link ") + name);
+                }
+            }
+            ++totals.links;
+            continue;
+        }
+        switch (chunk.part) {
+        case Flat:
+            std::snprintf(name, sizeof(name), "soubor%07llu.dat", n);
+            createFile(dirFd, name, 0, chunk.part, i, false);
+            break;
+        case Mixed: {
+            // 80 % do 16 KiB, 19 % do 256 KiB, 1 % 1-16 MiB, prumerne kolem 120 KiB na soubor
+            std::uint64_t size = random % 100 == 0 ? (1 + (random >> 8) % 16) << 20
+                : random % 100 < 20 ? (random >> 8) % (256 << 10) : (random >> 8) % (16 << 10);
+            std::snprintf(name, sizeof(name), "soubor%07llu.%s", n, extensions[(random >> 16) % 8]);
+            createFile(dirFd, name, size, chunk.part, i, false);
+            break;
+        }
+        case Sparse:
+            std::snprintf(name, sizeof(name), "ridky%06llu.img", n);
+            createFile(dirFd, name, (1 + random % 4) << 30, chunk.part, i, true);
+            break;
+        default: // cile odkazu
+            std::snprintf(name, sizeof(name), "cil%06llu.txt", n);
+            createFile(dirFd, name, random % 4096, chunk.part, i, false);
+        }
+    }
+    ::close(dirFd);
+}
+
+// vlakna si berou kusy ze spolecneho pocitadla, na poradi nezalezi
+void Generator::runChunks(const std::vector<Chunk>& chunks) {
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < spec.threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < chunks.size(); i = next++) {
+                runChunk(chunks[i]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// hluboky retez je ze sve podstaty seriovy; kazda uroven se otevre vuci predchozi,
+// takze cesta muze byt delsi nez PATH_MAX
+void Generator::createChain() {
+    if (::mkdirat(rootFd, "retez", 0755) != 0 && errno != EEXIST) {
+        fail("mkdir retez");
+        return;
+    }
+    int dirFd = ::openat(rootFd, "retez", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    for (std::uint64_t level = 0; dirFd >= 0 && level < spec.counts[Chain]; ++level) {
+        createFile(dirFd, "soubor.txt", valueFor(spec.seed, Chain, level, 1) % 4096, Chain, level, false);
+        int child = -1;
+        if (level + 1 < spec.counts[Chain]) {
+            if (::mkdirat(dirFd, "d", 0755) == 0) {
+                child = ::openat(dirFd, "d", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            }
+            if (child < 0) {
+                fail("mkdir retez/.../d");
+            }
+        }
+        timespec times[2];
+        setTimes(times, Chain, spec.counts[Chain] + level); // uroven je hotova, dalsi zmeny uz jsou jen v potomkovi
+        ::futimens(dirFd, times);
+        ::close(dirFd);
+        dirFd = child;
+    }
+}
+
+void Generator::run() {
+    std::vector<Chunk> files;
+    std::vector<Chunk> links;
+    plan(files, links);
+    std::thread chain; // retez bezi vedle ostatnich casti
+    if (spec.counts[Chain]) {
+        chain = std::thread([this] { createChain(); });
+    }
+    runChunks(files);
+    runChunks(links); // pevne odkazy potrebuji existujici cile
+    if (chain.joinable()) {
+        chain.join();
+    }
+    // slozky az po obsahu, potomci pred rodici; jinak by jejich cas byl cas posledniho zalozeneho souboru
+    if (spec.counts[Chain]) {
+        directories.push_back("retez");
+    }
+    timespec times[2];
+    for (size_t i = directories.size(); i-- > 0;) {
+        setTimes(times, PartCount, i);
+        ::utimensat(rootFd, directories[i].c_str(), times, 0);
+    }
+    setTimes(times, PartCount, directories.size());
+    ::futimens(rootFd, times);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Pouziti: GeneratorStromu <cil> ploche=N,smisene=N,ridke=N,retez=N,odkazy=N,pevne=N[,seed=S][,vlakna=T]\n";
+        return 1;
+    }
+    Spec spec;
+    std::string error;
+    if (!spec.parse(argv[2], error)) {
+        std::cerr << "Chybna specifikace: " << error << "\n";
+        return 1;
+    }
+    // do existujiciho stromu by se nove soubory michaly se starymi a vysledek by nebyl opakovatelny
+    if (::mkdir(argv[1], 0755) != 0) {
+        std::cerr << "Cil " << argv[1] << " nelze vytvorit: " << std::strerror(errno) << " (musi jeste neexistovat)\n";
+        return 1;
+    }
+    int rootFd = ::open(argv[1], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        std::cerr << "Cil " << argv[1] << " nelze otevrit: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    Generator generator(rootFd, spec);
+    generator.run();
+    ::close(rootFd);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Souboru: " << generator.totals.files << ", odkazu: " << generator.totals.links
+        << ", prideleno " << (generator.totals.allocated >> 20) << " MiB za " << seconds << " s ("
+        << static_cast<long long>((generator.totals.files + generator.totals.links) / std::max(seconds, 1e-9)) << " polozek/s), vlaken: "
+        << spec.threads << "\n";
+    if (generator.totals.errors) {
+        std::cerr << "Chyb: " << generator.totals.errors << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,311 @@
+﻿// Hledani.cpp: Rozbor dotazu, glob a ParallelFind, viz Hledani.h
+
+#include "Hledani.h"
+#include "CteniSlozky.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+bool globMatch(std::string_view pattern, std::string_view name) {
+    size_t p = 0, n = 0;
+    size_t starP = std::string_view::npos, starN = 0; // posledni hvezdicka pro navrat
+    while (n < name.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starN = n;
+            continue;
+        }
+        if (p < pattern.size()) {
+            bool matched = false;
+            size_t next = p + 1;
+            if (pattern[p] == '?') {
+                matched = true;
+            }
+            else if (pattern[p] == '[') {
+                size_t q = p + 1;
+                bool negate = q < pattern.size() && (pattern[q] == '!' || pattern[q] == '^');
+                q += negate;
+                bool inClass = false;
+                size_t first = q;
+                while (q < pattern.size() && (pattern[q] != ']' || q == first)) {
+                    if (q + 2 < pattern.size() && pattern[q + 1] == '-' && pattern[q + 2] != ']') {
+                        inClass |= name[n] >= pattern[q] && name[n] <= pattern[q + 2];
+                        q += 3;
+                    }
+                    else {
+                        inClass |= name[n] == pattern[q++];
+                    }
+                }
+                if (q < pattern.size()) { // uzavrena trida
+                    matched = inClass != negate;
+                    next = q + 1;
+                }
+                else {
+                    matched = name[n] == '['; // bez ] je to obycejny znak
+                }
+            }
+            else {
+                size_t literal = p + (pattern[p] == '\\' && p + 1 < pattern.size());
+                matched = pattern[literal] == name[n];
+                next = literal + 1;
+            }
+            if (matched) {
+                p = next;
+                ++n;
+                continue;
+            }
+        }
+        if (starP == std::string_view::npos) {
+            return false;
+        }
+        p = starP + 1; // hvezdicka pohlti o znak vic
+        n = ++starN;
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool FindQuery::parse(const std::string& text, std::string& error) {
+    std::istringstream in(text);
+    std::string token;
+    auto number = [&](const std::string& value, char& sign, double& amount) {
+        sign = (!value.empty() && (value[0] == '+' || value[0] == '-')) ? value[0] : 0;
+        try {
+            size_t used = 0;
+            amount = std::stod(value.substr(sign ? 1 : 0), &used);
+            return true;
+        }
+        catch (const std::exception&) {
+            error = "Neplatne cislo: " + value;
+            return false;
+        }
+    };
+    while (in >> token) {
+        if (token == "-name" && in >> token) {
+            pattern = token;
+        }
+        else if (token == "-size" && in >> token) {
+            char sign;
+            double amount;
+            if (!number(token, sign, amount)) {
+                return false;
+            }
+            char unit = token.back();
+            double scale = unit == 'k' || unit == 'K' ? 1024.0 : unit == 'M' ? 1024.0 * 1024 : unit == 'G' ? 1024.0 * 1024 * 1024 : 1.0;
+            auto bytes = static_cast<std::int64_t>(amount * scale);
+            if (sign != '-') {
+                minSize = sign == '+' ? bytes : bytes - 1; // bez znamenka presne
+            }
+            if (sign != '+') {
+                maxSize = sign == '-' ? bytes : bytes + 1;
+            }
+        }
+        else if (token == "-mtime" && in >> token) {
+            char sign;
+            double days;
+            if (!number(token, sign, days)) {
+                return false;
+            }
+            std::time_t now = std::time(nullptr);
+            std::time_t boundary = now - static_cast<std::time_t>(days * 86400);
+            if (sign == '-') {
+                newerThan = boundary;
+            }
+            else if (sign == '+') {
+                olderThan = boundary;
+            }
+            else { // pred N az N+1 dny
+                olderThan = boundary;
+                newerThan = boundary - 86400;
+            }
+        }
+        else if (token[0] != '-') {
+            pattern = token; // samotny vzor bez -name
+        }
+        else {
+            error = "Neznamy prepinac: " + token;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FindQuery::matches(std::string_view name, const EntryInfo& info) const {
+    if (!pattern.empty() && !globMatch(pattern, name)) {
+        return false;
+    }
+    if (minSize >= 0 || maxSize >= 0) {
+        if (!info.sizeKnown || (minSize >= 0 && static_cast<std::int64_t>(info.size) <= minSize)
+            || (maxSize >= 0 && static_cast<std::int64_t>(info.size) >= maxSize)) {
+            return false;
+        }
+    }
+    if (newerThan || olderThan) {
+        if (!info.timeKnown || (newerThan && info.modified <= newerThan) || (olderThan && info.modified >= olderThan)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ParallelFind::threadsFor(const std::string& root) {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+#ifdef __linux__
+    struct statfs info {};
+    if (::statfs(root.c_str(), &info) == 0) {
+        switch (static_cast<unsigned long>(info.f_type)) {
+        case 0x6969:     // NFS
+        case 0xFE534D42: // SMB2
+        case 0xFF534D42: // CIFS
+        case 0x65735546: // FUSE
+            return std::min<size_t>(cores, 4); // kazdy dotaz je cesta po siti, server nezahltit
+        default:
+            break;
+        }
+    }
+#else
+    (void)root;
+#endif
+    return std::min<size_t>(cores * 2, 16); // vlakna cekajici na disk, NVMe zvlada hluboke fronty
+}
+
+void ParallelFind::run(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    queues.clear();
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    pending = 1;
+    queues[0]->dirs.push_back(std::string());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&ParallelFind::worker, this, i);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool ParallelFind::take(size_t self, std::string& dir) {
+    {
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        if (!queues[self]->dirs.empty()) {
+            dir = std::move(queues[self]->dirs.back());
+            queues[self]->dirs.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        WorkQueue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.dirs.empty()) {
+            dir = std::move(victim.dirs.front()); // nejstarsi slozka, nejspis s nejvetsim podstromem
+            victim.dirs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParallelFind::anyQueued() {
+    for (auto& queue : queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->dirs.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fronty se testuji pod idleMutex; kdo slozku pridal, bere idleMutex az potom, takze probuzeni neprijde vnivec
+void ParallelFind::waitForWork() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    ++sleepers;
+    workAvailable.wait(lock, [this] { return pending == 0 || cancelled || anyQueued(); });
+    --sleepers;
+}
+
+void ParallelFind::wakeSleepers(bool all) {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        if (sleepers == 0) {
+            return;
+        }
+    }
+    if (all) {
+        workAvailable.notify_all();
+    }
+    else {
+        workAvailable.notify_one();
+    }
+}
+
+void ParallelFind::worker(size_t self) {
+    EntryTable batch;
+    auto lastFlush = std::chrono::steady_clock::now();
+    auto flush = [&] {
+        if (!batch.empty()) {
+            onBatch(batch);
+            batch.clear();
+        }
+        lastFlush = std::chrono::steady_clock::now();
+    };
+    std::string dir;
+    std::string path;
+    std::string relative;
+    while (pending > 0 && !cancelled) {
+        if (!take(self, dir)) {
+            flush(); // pri cekani na praci at jsou nalezene polozky hned videt
+            waitForWork();
+            continue;
+        }
+        size_t found = 0; // novych podslozek v teto slozce
+        path = dir.empty() ? root : (root == "/" ? "/" + dir : root + "/" + dir);
+        std::string error;
+        bool complete = enumerateDirectory(path, [&](std::string_view name, const EntryInfo& info) {
+            if (cancelled) {
+                return false;
+            }
+            ++scanned;
+            relative.assign(dir);
+            if (!relative.empty()) {
+                relative.push_back('/');
+            }
+            relative.append(name);
+            if (info.isDirectory && !info.isSymlink) {
+                ++pending;
+                ++found;
+                std::lock_guard<std::mutex> lock(queues[self]->mutex);
+                queues[self]->dirs.push_back(relative);
+            }
+            if (query.matches(name, info)) {
+                batch.push(relative, info);
+            }
+            return true;
+        }, error, query.needsMetadata());
+        if (!complete && !cancelled) {
+            ++errors; // napr. slozka bez prava cteni, hledani pokracuje dal
+        }
+        ++directories;
+        if (--pending == 0) {
+            wakeSleepers(true); // vse prohledano, cekajici vlakna skonci
+        }
+        else if (found) {
+            wakeSleepers(found > 1); // necinne vlakno si slozku ukradne
+        }
+        if (batch.size() >= 1024 || std::chrono::steady_clock::now() - lastFlush > std::chrono::milliseconds(50)) {
+            flush();
+        }
+    }
+    wakeSleepers(true); // po zruseni necekaji ostatni na slozky, ktere uz nikdo neprecte
+    flush();
+}
@@ -0,0 +1,71 @@
+﻿// Hledani.h: Dotaz ve stylu find(1) a paralelni rekurzivni hledani (ParallelFind).
+
+#pragma once
+
+#include "TabulkaPolozek.h"
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Dotaz hledani ve stylu find(1): vzor jmena (glob s * ? [...]), -size [+-]N[kMG], -mtime [+-]N ve dnech.
+struct FindQuery {
+    std::string pattern;           // prazdny = kazde jmeno
+    std::int64_t minSize = -1;     // velikost > minSize
+    std::int64_t maxSize = -1;     // velikost < maxSize
+    std::time_t newerThan = 0;     // zmena po tomto case
+    std::time_t olderThan = 0;     // zmena pred timto casem
+
+    bool parse(const std::string& text, std::string& error);
+    bool needsMetadata() const { return minSize >= 0 || maxSize >= 0 || newerThan || olderThan; }
+    bool matches(std::string_view name, const EntryInfo& info) const;
+};
+
+// glob jako fnmatch bez priznaku: * a ? nahradi libovolne znaky, [abc] [a-z] [!a] tridu znaku
+bool globMatch(std::string_view pattern, std::string_view name);
+
+// Paralelni rekurzivni hledani. Kazde vlakno ma vlastni frontu slozek: nove slozky pridava na
+// konec a bere je odtamtud (do hloubky, blizko sebe na disku), necinne vlakno krade ze zacatku
+// cizich front. Shody se posilaji po davkach do onBatch, ktery muze byt volan z vice vlaken.
+struct ParallelFind {
+    using BatchHandler = std::function<void(EntryTable& batch)>;
+
+    ParallelFind(const FindQuery& query, std::string root, const std::atomic<bool>& cancelled, BatchHandler onBatch)
+        : query(query), root(std::move(root)), cancelled(cancelled), onBatch(std::move(onBatch)) {}
+
+    void run(size_t threadCount); // vrati se az po prohledani vseho nebo po zruseni
+    static size_t threadsFor(const std::string& root); // na sitovem disku mene vlaken
+    std::atomic<size_t> directories{ 0 };
+    std::atomic<size_t> scanned{ 0 };
+    std::atomic<size_t> errors{ 0 };
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::string> dirs; // cesty relativni k root, "" je root
+    };
+
+    const FindQuery& query;
+    std::string root;
+    const std::atomic<bool>& cancelled;
+    BatchHandler onBatch;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<size_t> pending{ 0 }; // slozky ve frontach nebo prave ctene, 0 = hotovo
+    std::mutex idleMutex;             // necinna vlakna cekaji na novou slozku nebo na konec
+    std::condition_variable workAvailable;
+    size_t sleepers = 0;              // chraneno idleMutex
+
+    bool take(size_t self, std::string& dir);
+    bool anyQueued();
+    void waitForWork();
+    void wakeSleepers(bool all);
+    void worker(size_t self);
+};
@@ -0,0 +1,110 @@
+﻿// HledaniBajtu.h: Hledani podretezce ve jmenech (bez ohledu na velikost ASCII pismen) a v obsahu
+// souboru, s SSE2 po 16 bajtech. Sdili ho filtr panelu a hledani textu.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPRAVCE_SSE2 // vektorove hledani ve jmenech
+#endif
+
+inline unsigned char lowerAscii(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+// Hledani filtru ve jmenech bez ohledu na velikost ASCII pismen. Po 16 bajtech se porovna prvni
+// a posledni znak jehly (SSE2), cely retezec se overuje jen u kandidatu. Cist se smi jen pred limit.
+inline bool equalNoCase(const char* text, const char* lowerNeedle, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (lowerAscii(static_cast<unsigned char>(text[i])) != static_cast<unsigned char>(lowerNeedle[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SPRAVCE_SSE2
+inline __m128i lower16(__m128i bytes) {
+    // 'A'..'Z' po posunu na -128..-103 jsou jedine mensi nez -102 (porovnani je se znamenkem)
+    __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+    __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    return _mm_add_epi8(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+inline int lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return static_cast<int>(bit);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+template <bool FoldCase>
+inline bool equalBytes(const char* text, const char* needle, size_t length) {
+    return FoldCase ? equalNoCase(text, needle, length) : std::memcmp(text, needle, length) == 0;
+}
+
+// onMatch(pozice) vrati pozici, od ktere se hleda dal (length = konec).
+// FoldCase: jehla je malymi pismeny a text se porovnava bez ohledu na velikost; jinak presne (obsah souboru).
+template <bool FoldCase, typename OnMatch>
+inline void findBytes(const char* text, size_t length, std::string_view lowerNeedle, const char* limit, OnMatch onMatch) {
+    const size_t m = lowerNeedle.size();
+    if (m == 0 || m > length) {
+        return;
+    }
+    size_t i = 0;
+#ifdef SPRAVCE_SSE2
+    const __m128i first = _mm_set1_epi8(lowerNeedle[0]);
+    const __m128i last = _mm_set1_epi8(lowerNeedle[m - 1]);
+    const size_t readable = static_cast<size_t>(limit - text);
+    while (i + m <= length && i + m - 1 + 16 <= readable) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + m - 1));
+        if (FoldCase) {
+            a = lower16(a);
+            b = lower16(b);
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        size_t next = i + 16;
+        while (mask) {
+            size_t position = i + lowestBit(mask);
+            mask &= mask - 1;
+            if (position + m > length) {
+                break;
+            }
+            if (m <= 2 || equalBytes<FoldCase>(text + position + 1, lowerNeedle.data() + 1, m - 2)) {
+                size_t resume = onMatch(position);
+                if (resume >= length) {
+                    return;
+                }
+                if (resume > position + 1) { // preskocit zbytek jmena
+                    next = std::max(next, resume);
+                    while (mask && i + lowestBit(mask) < resume) {
+                        mask &= mask - 1;
+                    }
+                }
+            }
+        }
+        i = next;
+    }
+#else
+    (void)limit;
+#endif
+    for (; i + m <= length; ++i) {
+        if (equalBytes<FoldCase>(text + i, lowerNeedle.data(), m)) {
+            size_t resume = onMatch(i);
+            if (resume >= length) {
+                return;
+            }
+            i = std::max(i, resume - 1);
+        }
+    }
+}
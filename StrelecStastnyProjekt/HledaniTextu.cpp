@@ -0,0 +1,228 @@
+﻿// HledaniTextu.cpp: mmap nebo cteni po 1 MiB a hledani po radcich, viz HledaniTextu.h
+
+#include "HledaniTextu.h"
+#include "HledaniBajtu.h"
+#include "PocitadloDotazu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+void ContentGrep::run(const std::vector<fs::path>& roots, const fs::path& base, size_t threadCount) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+        threads.emplace_back(&ContentGrep::worker, this);
+    }
+    auto enqueue = [this](std::string path, std::string relative) {
+        std::lock_guard<std::mutex> lock(mutex);
+        files.emplace_back(std::move(path), std::move(relative));
+        wake.notify_one();
+    };
+    for (const auto& root : roots) {
+        std::string prefix = root.lexically_relative(base).generic_string();
+        std::error_code error;
+        if (!fs::is_directory(fs::symlink_status(root, error))) {
+            enqueue(root.string(), prefix);
+            continue;
+        }
+        FindQuery everything;
+        ParallelFind find(everything, root.string(), cancelled, [&](EntryTable& batch) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (!batch.isDirectory(i) && !(batch.flags[i] & EntryTable::Symlink)) {
+                    std::string name(batch.name(i));
+                    enqueue(root.string() + "/" + name, prefix == "." ? name : prefix + "/" + name);
+                }
+            }
+        });
+        find.run(ParallelFind::threadsFor(root.string()));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        listed = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ContentGrep::worker() {
+    EntryTable batch;
+    auto lastFlush = std::chrono::steady_clock::now();
+    while (!cancelled) {
+        std::pair<std::string, std::string> file;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (files.empty() && !batch.empty()) {
+                lock.unlock();
+                onBatch(batch); // nez se zacne cekat, at jsou nalezene radky videt
+                batch.clear();
+                lastFlush = std::chrono::steady_clock::now();
+                continue;
+            }
+            wake.wait_for(lock, std::chrono::milliseconds(50), [this] { return !files.empty() || listed || cancelled; });
+            if (files.empty()) {
+                if (listed) {
+                    break;
+                }
+                continue;
+            }
+            file = std::move(files.front());
+            files.pop_front();
+        }
+        scanFile(file.first, file.second, batch);
+        if (batch.size() >= 256 || std::chrono::steady_clock::now() - lastFlush > std::chrono::milliseconds(50)) {
+            onBatch(batch);
+            batch.clear();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+    }
+    if (!batch.empty()) {
+        onBatch(batch);
+    }
+}
+
+bool ContentGrep::scanLines(const char* data, size_t size, size_t& line, const std::string& relative, const EntryInfo& info,
+    EntryTable& batch) {
+    if (line == 1 && std::memchr(data, 0, std::min<size_t>(size, 8192)) != nullptr) {
+        ++binarySkipped; // stejna heuristika jako grep: nula v prvnich 8 KiB
+        return false;
+    }
+    const char* counted = data; // do teto pozice uz jsou konce radku spocitane
+    std::string name;
+    findBytes<false>(data, size, needle, data + size, [&](size_t position) {
+        const char* match = data + position;
+        line += std::count(counted, match, '\n');
+        const char* begin = match;
+        while (begin > data && begin[-1] != '\n') {
+            --begin;
+        }
+        const char* end = static_cast<const char*>(std::memchr(match, '\n', data + size - match));
+        end = end ? end : data + size;
+        // jmeno vysledku: cesta, nula, cislo radku a zacatek radku; cname() pak vrati jen cestu
+        name.assign(relative);
+        name.push_back('\0');
+        name += std::to_string(line) + ": ";
+        for (const char* c = begin; c < end && c < begin + 200; ++c) {
+            name.push_back(static_cast<unsigned char>(*c) < ' ' ? ' ' : *c); // ridici znaky by rozbily obrazovku
+        }
+        batch.push(name, info);
+        counted = end;
+        return static_cast<size_t>(end - data) + 1; // dalsi shoda az na dalsim radku
+    });
+    line += std::count(counted, data + size, '\n');
+    return true;
+}
+
+void ContentGrep::scanFile(const std::string& path, const std::string& relative, EntryTable& batch) {
+    ++filesScanned;
+    size_t line = 1;
+#ifdef __linux__
+    // O_NONBLOCK: FIFO bez zapisovatele by open zablokoval a run by na vlakno cekal navzdy
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        return;
+    }
+    ++fsCalls;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd); // zarizeni a pipe se neprohledavaji
+        return;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    EntryInfo info;
+    info.size = static_cast<std::uintmax_t>(st.st_size);
+    info.sizeKnown = true;
+    info.modified = st.st_mtime;
+    info.timeKnown = true;
+    info.metaLoaded = true;
+    if (st.st_size > 0) {
+        void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            ::madvise(mapped, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL); // agresivni readahead
+            bytesScanned += static_cast<std::uint64_t>(st.st_size);
+            scanLines(static_cast<const char*>(mapped), static_cast<size_t>(st.st_size), line, relative, info, batch);
+            ::munmap(mapped, static_cast<size_t>(st.st_size));
+            ::close(fd);
+            return;
+        }
+    }
+    auto readChunk = [fd](char* buffer, size_t size) { return static_cast<long>(::read(fd, buffer, size)); };
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    EntryInfo info;
+    auto readChunk = [&in](char* buffer, size_t size) {
+        in.read(buffer, static_cast<std::streamsize>(size));
+        return static_cast<long>(in.gcount());
+    };
+#endif
+    // po kusech: prohledaji se jen cele radky, rozdelany radek se prenese do dalsiho kusu
+    const size_t chunkSize = 1 << 20;
+    std::vector<char> buffer(chunkSize);
+    size_t carried = 0;
+    bool lineReported = false; // radek delsi nez buffer uz ma shodu, jeho zbytek se neprohledava
+    long length;
+    while (!cancelled && (length = readChunk(buffer.data() + carried, buffer.size() - carried)) > 0) {
+        size_t filled = carried + static_cast<size_t>(length);
+        bytesScanned += static_cast<std::uint64_t>(length);
+        if (lineReported) {
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data(), '\n', filled));
+            if (!newline) {
+                carried = 0;
+                continue;
+            }
+            size_t skipped = static_cast<size_t>(newline - buffer.data()) + 1;
+            ++line;
+            lineReported = false;
+            filled -= skipped;
+            std::memmove(buffer.data(), buffer.data() + skipped, filled);
+        }
+        const char* lastNewline = nullptr;
+        for (size_t i = filled; i > 0; --i) {
+            if (buffer[i - 1] == '\n') {
+                lastNewline = buffer.data() + i - 1;
+                break;
+            }
+        }
+        if (!lastNewline) {
+            if (filled < buffer.size()) {
+                carried = filled; // radek jeste neskoncil a v bufferu je misto
+                continue;
+            }
+            // radek delsi nez buffer: shoda muze lezet pres hranici kusu, proto se konec kusu
+            // (o bajt kratsi nez hledany text) prenese a prohleda znovu s dalsim kusem
+            size_t found = batch.size();
+            if (!scanLines(buffer.data(), filled, line, relative, info, batch)) {
+                break;
+            }
+            lineReported = batch.size() > found;
+            carried = lineReported || needle.empty() ? 0 : std::min(filled, needle.size() - 1);
+            std::memmove(buffer.data(), buffer.data() + filled - carried, carried);
+            continue;
+        }
+        size_t complete = static_cast<size_t>(lastNewline - buffer.data()) + 1;
+        if (!scanLines(buffer.data(), complete, line, relative, info, batch)) {
+            break;
+        }
+        carried = filled - complete;
+        std::memmove(buffer.data(), buffer.data() + complete, carried);
+    }
+    if (carried > 0 && !cancelled) {
+        scanLines(buffer.data(), carried, line, relative, info, batch); // posledni radek bez konce
+    }
+#ifdef __linux__
+    ::close(fd);
+#endif
+}
@@ -0,0 +1,48 @@
+﻿// HledaniTextu.h: Hledani textu v obsahu souboru (ContentGrep).
+
+#pragma once
+
+#include "Hledani.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Hledani textu v obsahu souboru. Jedno vlakno vypisuje soubory (ParallelFind pro slozky),
+// ostatni je berou z fronty a prohledavaji: soubor se namapuje do pameti, kdyz to nejde
+// (prazdna velikost v /proc, pipe), cte se po 1 MiB. Soubory s nulovym bajtem na zacatku se
+// povazuji za binarni a preskoci se. Shoda se hlasi jednou za radek.
+struct ContentGrep {
+    using BatchHandler = ParallelFind::BatchHandler;
+
+    ContentGrep(std::string needle, const std::atomic<bool>& cancelled, BatchHandler onBatch)
+        : needle(std::move(needle)), cancelled(cancelled), onBatch(std::move(onBatch)) {}
+
+    // roots jsou soubory nebo slozky, vysledky se jmenuji relativne k base
+    void run(const std::vector<fs::path>& roots, const fs::path& base, size_t threadCount);
+    std::atomic<size_t> filesScanned{ 0 };
+    std::atomic<size_t> binarySkipped{ 0 };
+    std::atomic<std::uint64_t> bytesScanned{ 0 };
+
+private:
+    std::string needle;
+    const std::atomic<bool>& cancelled;
+    BatchHandler onBatch;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::pair<std::string, std::string>> files; // cela cesta, jmeno ve vysledcich
+    bool listed = false; // vypis souboru skoncil
+
+    void worker();
+    void scanFile(const std::string& path, const std::string& relative, EntryTable& batch);
+    // prohleda cele radky v [data, data + size), line je cislo radku na zacatku; vraci false u binarniho souboru
+    bool scanLines(const char* data, size_t size, size_t& line, const std::string& relative, const EntryInfo& info, EntryTable& batch);
+};
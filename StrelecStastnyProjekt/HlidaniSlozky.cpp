@@ -0,0 +1,80 @@
+﻿// HlidaniSlozky.cpp: inotify na Linuxu, jinde prazdna implementace
+
+#include "HlidaniSlozky.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+DirectoryWatcher::DirectoryWatcher() {
+    fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void DirectoryWatcher::watch(const std::string& path) {
+    if (fd < 0 || path == watchedPath) {
+        return;
+    }
+    if (wd >= 0) {
+        ::inotify_rm_watch(fd, wd);
+    }
+    std::vector<Event> stale;
+    readEvents(stale); // udalosti ze stare slozky uz nepatri k novemu seznamu
+    wd = ::inotify_add_watch(fd, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+        | IN_CLOSE_WRITE | IN_ATTRIB | IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    watchedPath = wd >= 0 ? path : std::string();
+}
+
+bool DirectoryWatcher::readEvents(std::vector<Event>& events) {
+    alignas(inotify_event) char buffer[64 * 1024];
+    bool complete = true;
+    ssize_t length;
+    while (fd >= 0 && (length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                complete = false;
+            }
+            if (event->wd != wd) {
+                continue; // udalost ze slozky, kterou uz panel nezobrazuje
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_UNMOUNT)) {
+                // slozka zmizela (IN_IGNORED i po odpojeni svazku), dalsi udalosti uz neprijdou
+                if (!(event->mask & IN_IGNORED)) {
+                    ::inotify_rm_watch(fd, wd); // presunuta slozka by se jinak hlidala dal pod novym jmenem
+                }
+                wd = -1;
+                watchedPath.clear();
+                events.push_back({ Event::Gone, std::string() });
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                events.push_back({ Event::Added, event->name });
+            }
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                events.push_back({ Event::Removed, event->name });
+            }
+            else {
+                events.push_back({ Event::Modified, event->name });
+            }
+        }
+    }
+    return complete;
+}
+#else
+DirectoryWatcher::DirectoryWatcher() {}
+DirectoryWatcher::~DirectoryWatcher() {}
+void DirectoryWatcher::watch(const std::string&) {} // mimo Linux se panel obnovuje celym pruchodem
+bool DirectoryWatcher::readEvents(std::vector<Event>&) { return true; }
+#endif
@@ -0,0 +1,28 @@
+﻿// HlidaniSlozky.h: Hlidani zmen v zobrazene slozce pres inotify.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Hlidani zmen v zobrazene slozce (inotify), panel podle udalosti upravi seznam na miste.
+// Kdyz je hlidana slozka smazana nebo presunuta, prijde udalost Gone (bez jmena) a hlidani skonci.
+struct DirectoryWatcher {
+    struct Event {
+        enum Type { Added, Removed, Modified, Gone } type;
+        std::string name;
+    };
+
+    int fd = -1;
+    int wd = -1;
+    std::string watchedPath;
+
+    DirectoryWatcher();
+    ~DirectoryWatcher();
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    bool active() const { return wd >= 0; } // bez hlidani je nutne obnovovat cely seznam
+    void watch(const std::string& path);
+    bool readEvents(std::vector<Event>& events); // false kdyz fronta udalosti pretekla
+};
@@ -0,0 +1,148 @@
+﻿// KopirovaniSouboru.cpp: reflink -> copy_file_range -> sendfile -> buffer, viz KopirovaniSouboru.h
+
+#include "KopirovaniSouboru.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+const char* copyMethodName(CopyMethod method) {
+    static const char* names[] = { "reflink", "copy_file_range", "sendfile", "buffer", "copy_file" };
+    return names[static_cast<int>(method)];
+}
+
+#ifdef __linux__
+// chyby, po kterych ma smysl zkusit dalsi zpusob kopirovani (jadro nebo FS ho nepodporuje)
+static bool copyUnsupported(int error) {
+    return error == EXDEV || error == EINVAL || error == ENOSYS || error == EOPNOTSUPP
+        || error == ENOTTY || error == EBADF || error == EPERM;
+}
+#endif
+
+CopyMethod copyFileFast(const fs::path& from, const fs::path& to, std::uintmax_t& bytes, std::error_code& ec,
+    const std::function<bool(std::uintmax_t)>& onChunk) {
+    bytes = 0;
+#ifdef __linux__
+    // O_NONBLOCK: open na FIFO bez zapisovatele by jinak cekal navzdy a ulohu by neslo zrusit
+    int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (in < 0) {
+        ec.assign(errno, std::generic_category());
+        return CopyMethod::Buffered;
+    }
+    struct stat st {};
+    if (::fstat(in, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ec = S_ISREG(st.st_mode) ? std::error_code(errno, std::generic_category()) : std::make_error_code(std::errc::not_supported);
+        ::close(in);
+        return CopyMethod::Buffered;
+    }
+    ::fcntl(in, F_SETFL, ::fcntl(in, F_GETFL) & ~O_NONBLOCK);
+    int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777);
+    if (out < 0) {
+        ec.assign(errno, std::generic_category());
+        ::close(in);
+        return CopyMethod::Buffered;
+    }
+    CopyMethod method = CopyMethod::Reflink;
+    std::uintmax_t total = static_cast<std::uintmax_t>(st.st_size);
+    int error = 0;
+    const std::uintmax_t chunk = 64u << 20; // po kouscich, aby slo velky soubor prerusit a merit prubeh
+    auto reportChunk = [&](std::uintmax_t n) {
+        if (onChunk && !onChunk(n)) {
+            error = ECANCELED;
+            return false;
+        }
+        return true;
+    };
+    if (::ioctl(out, FICLONE, in) == 0) {
+        bytes = total;
+        reportChunk(total);
+    }
+    else {
+        method = CopyMethod::CopyFileRange;
+        while (bytes < total) {
+            ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, std::min(total - bytes, chunk), 0);
+            if (n <= 0) {
+                error = n < 0 ? errno : 0;
+                break; // n == 0: soubor se mezitim zkratil
+            }
+            bytes += static_cast<std::uintmax_t>(n);
+            if (!reportChunk(static_cast<std::uintmax_t>(n))) {
+                break;
+            }
+        }
+        if (error && bytes == 0 && copyUnsupported(error)) {
+            error = 0;
+            method = CopyMethod::Sendfile;
+            while (bytes < total) {
+                ssize_t n = ::sendfile(out, in, nullptr, std::min(total - bytes, chunk));
+                if (n <= 0) {
+                    error = n < 0 ? errno : 0;
+                    break;
+                }
+                bytes += static_cast<std::uintmax_t>(n);
+                if (!reportChunk(static_cast<std::uintmax_t>(n))) {
+                    break;
+                }
+            }
+        }
+        if (error && bytes == 0 && copyUnsupported(error)) {
+            error = 0;
+            method = CopyMethod::Buffered;
+            std::vector<char> buffer(1 << 20);
+            while (true) {
+                ssize_t n = ::read(in, buffer.data(), buffer.size());
+                if (n <= 0) {
+                    error = n < 0 ? errno : 0;
+                    break;
+                }
+                for (ssize_t written = 0; written < n;) {
+                    ssize_t w = ::write(out, buffer.data() + written, static_cast<size_t>(n - written));
+                    if (w <= 0) { // castecny zapis se opakuje, 0 by se jinak tocilo navzdy
+                        error = w < 0 ? errno : EIO;
+                        break;
+                    }
+                    written += w;
+                }
+                if (error) {
+                    break;
+                }
+                bytes += static_cast<std::uintmax_t>(n);
+                if (!reportChunk(static_cast<std::uintmax_t>(n))) {
+                    break;
+                }
+            }
+        }
+    }
+    if (error) {
+        ec.assign(error, std::generic_category());
+    }
+    ::close(in);
+    if (::close(out) != 0 && !error) {
+        ec.assign(errno, std::generic_category()); // napr. NFS hlasi chybu zapisu az pri close
+    }
+    if (ec) {
+        ::unlink(to.c_str()); // nenechavat po chybe polovicni soubor
+    }
+    return method;
+#else
+    fs::copy_file(from, to, fs::copy_options::none, ec);
+    if (!ec) {
+        bytes = fs::file_size(to, ec);
+        if (onChunk) {
+            onChunk(bytes);
+        }
+    }
+    return CopyMethod::Library;
+#endif
+}
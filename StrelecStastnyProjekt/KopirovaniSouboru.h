@@ -0,0 +1,28 @@
+﻿// KopirovaniSouboru.h: Kopie jednoho souboru nejlevnejsim zpusobem, ktery jadro a souborovy
+// system umi. Sdili ji spravce souboru (CMakeProject16) i CMakeProject11.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+
+// Zpusob, kterym byl soubor zkopirovan (od nejlevnejsiho)
+enum class CopyMethod {
+    Reflink,       // FICLONE, sdilene bloky na btrfs/XFS, data se nekopiruji vubec
+    CopyFileRange, // kopirovani v jadre, muze vyuzit i kopirovani na strane serveru (NFS)
+    Sendfile,      // kopirovani v jadre bez pruchodu pres uzivatelsky prostor
+    Buffered,      // cteni a zapis pres vlastni buffer
+    Library,       // std::filesystem::copy_file (mimo Linux)
+    Count
+};
+
+const char* copyMethodName(CopyMethod method);
+
+// Kopie jednoho souboru, zkousi reflink -> copy_file_range -> sendfile -> buffer.
+// Cilovy soubor nesmi existovat, stejne jako u fs::copy_options::none.
+// onChunk dostava pocet prave zkopirovanych bajtu, kdyz vrati false, kopirovani se prerusi.
+// Chyba se vraci v ec (nevyhazuje se), po chybe cilovy soubor nezustane.
+CopyMethod copyFileFast(const std::filesystem::path& from, const std::filesystem::path& to, std::uintmax_t& bytes,
+    std::error_code& ec, const std::function<bool(std::uintmax_t)>& onChunk = {});
@@ -0,0 +1,177 @@
+﻿// KopirovaniStromu.cpp: Implementace CopyEngine, viz KopirovaniStromu.h
+
+#include "KopirovaniStromu.h"
+
+void CopyEngine::run(const std::vector<Task>& items) {
+    walkDone = false;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&CopyEngine::worker, this);
+    }
+    for (const auto& item : items) {
+        if (!job.progress.checkpoint()) {
+            break;
+        }
+        walk(item);
+    }
+    job.progress.scanDone = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        walkDone = true;
+    }
+    notEmpty.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+    // podslozky pred rodici; neprazdna slozka (chyba nebo zruseni) zustane i se zbytkem obsahu
+    for (auto it = sourceDirs.rbegin(); it != sourceDirs.rend(); ++it) {
+        std::error_code ec;
+        fs::remove(*it, ec);
+        if (ec && ec != std::errc::directory_not_empty) {
+            job.addError(*it, ec.message());
+        }
+    }
+}
+
+void CopyEngine::walk(const Task& item) {
+    std::error_code ec;
+    auto status = fs::symlink_status(item.from, ec);
+    if (ec) {
+        job.addError(item.from, ec.message());
+        return;
+    }
+    if (!fs::is_directory(status)) {
+        if (!copyable(item.from, status)) {
+            return;
+        }
+        ++job.progress.filesTotal;
+        if (fs::is_regular_file(status)) {
+            job.progress.bytesTotal += fs::file_size(item.from, ec);
+        }
+        push(item);
+        return;
+    }
+    if (!fs::create_directory(item.to, ec)) {
+        job.addError(item.to, ec ? ec.message() : "cil uz existuje");
+        return;
+    }
+    if (removeSources) {
+        sourceDirs.push_back(item.from);
+    }
+    // pruchod do hloubky v poradi predchudcu, slozka vznikne drive nez jeji obsah
+    fs::recursive_directory_iterator it(item.from, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!job.progress.checkpoint()) {
+            return;
+        }
+        fs::path target = item.to / it->path().lexically_relative(item.from);
+        if (it->is_directory(ec) && !it->is_symlink(ec)) {
+            if (!fs::create_directory(target, ec) && ec) {
+                job.addError(target, ec.message());
+                it.disable_recursion_pending(); // bez slozky nema smysl kopirovat jeji obsah
+                ec.clear();
+            }
+            else if (removeSources) {
+                sourceDirs.push_back(it->path());
+            }
+        }
+        else {
+            fs::file_status entryStatus = it->symlink_status(ec);
+            ec.clear();
+            if (!copyable(it->path(), entryStatus)) {
+                continue;
+            }
+            ++job.progress.filesTotal;
+            if (fs::is_regular_file(entryStatus)) {
+                job.progress.bytesTotal += it->file_size(ec);
+            }
+            ec.clear();
+            push({ it->path(), target });
+        }
+    }
+    if (ec) {
+        job.addError(item.from, ec.message());
+    }
+}
+
+bool CopyEngine::copyable(const fs::path& path, fs::file_status status) {
+    if (fs::is_regular_file(status) || fs::is_symlink(status)) {
+        return true; // odkaz zkopiruje pracovni vlakno pres copy_symlink
+    }
+    job.addError(path, removeSources ? "neni obycejny soubor (FIFO, socket nebo zarizeni), zustava na miste"
+        : "neni obycejny soubor (FIFO, socket nebo zarizeni), preskoceno");
+    return false;
+}
+
+void CopyEngine::push(Task task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [&] { return queue.size() < queueLimit; });
+    queue.push_back(std::move(task));
+    lock.unlock();
+    notEmpty.notify_one();
+}
+
+void CopyEngine::worker() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !queue.empty() || walkDone; });
+        if (queue.empty()) {
+            return; // fronta prazdna a pruchod skoncil
+        }
+        Task task = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        if (!job.progress.checkpoint()) {
+            continue; // zruseno, fronta se jen vyprazdni
+        }
+
+        std::error_code ec;
+        std::uintmax_t bytes = 0;
+        if (fs::is_symlink(fs::symlink_status(task.from, ec))) {
+            fs::copy_symlink(task.from, task.to, ec); // odkaz se kopiruje jako odkaz, ne jeho cil
+        }
+        else {
+            CopyMethod method = copyFileFast(task.from, task.to, bytes, ec, [&](std::uintmax_t n) {
+                job.progress.bytesDone += n;
+                return job.progress.checkpoint();
+            });
+            if (!ec) {
+                ++methodCounts[static_cast<int>(method)];
+            }
+        }
+        if (ec) {
+            job.addError(task.from, ec.message());
+            continue;
+        }
+        if (removeSources && verified(task, bytes) && !fs::remove(task.from, ec)) {
+            job.addError(task.from, ec ? ec.message() : "zdroj uz neexistuje"); // kopie je hotova, zdroj zustal
+        }
+        ++job.progress.filesDone;
+    }
+}
+
+bool CopyEngine::verified(const Task& task, std::uintmax_t bytes) {
+    std::error_code ec;
+    if (!fs::is_regular_file(fs::symlink_status(task.from, ec))) {
+        return !ec; // odkaz: staci, ze copy_symlink uspel
+    }
+    std::uintmax_t from = fs::file_size(task.from, ec);
+    std::uintmax_t to = ec ? 0 : fs::file_size(task.to, ec);
+    if (ec || from != bytes || to != bytes) {
+        job.addError(task.from, ec ? ec.message() : "zdroj se behem presunu zmenil, zustava na miste");
+        return false;
+    }
+    return true;
+}
+
+std::string CopyEngine::methodSummary() const {
+    std::string summary;
+    for (int i = 0; i < static_cast<int>(CopyMethod::Count); ++i) {
+        if (methodCounts[i]) {
+            summary += (summary.empty() ? "" : ", ") + std::string(copyMethodName(static_cast<CopyMethod>(i)))
+                + " " + std::to_string(methodCounts[i].load());
+        }
+    }
+    return summary;
+}
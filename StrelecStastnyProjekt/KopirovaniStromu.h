@@ -0,0 +1,48 @@
+﻿// KopirovaniStromu.h: Paralelni kopirovani stromu slozek pro ulohy kopirovani a presunu.
+
+#pragma once
+
+#include "Ulohy.h"
+#include "KopirovaniSouboru.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Paralelni kopirovani: jedno vlakno prochazi zdrojove stromy a zaklada slozky,
+// soubory kopiruje omezeny pocet pracovnich vlaken
+struct CopyEngine {
+    struct Task {
+        fs::path from;
+        fs::path to;
+    };
+
+    size_t workerCount;
+    size_t queueLimit = 4096; // omezena fronta, pruchod stromem nepredbehne kopirovani o miliony cest
+    std::deque<Task> queue;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    bool walkDone = false;
+    Job& job; // prubeh, pauza, zruseni a chyby
+    std::atomic<size_t> methodCounts[static_cast<int>(CopyMethod::Count)] = {}; // kolik souboru kterym zpusobem
+    bool removeSources = false; // presun mezi svazky: zdroj se smaze hned po overene kopii
+    std::vector<fs::path> sourceDirs; // zdrojove slozky v poradi pruchodu, pri presunu se na konci odstrani
+
+    explicit CopyEngine(Job& owner, size_t workers = 0)
+        : workerCount(workers ? workers : std::max(2u, std::thread::hardware_concurrency())), job(owner) {}
+
+    void run(const std::vector<Task>& items); // zdroj -> cil, vrati se az je vse zkopirovano
+    void walk(const Task& item);
+    bool copyable(const fs::path& path, fs::file_status status); // FIFO, socket a zarizeni se preskoci s chybou
+    void push(Task task);
+    void worker();
+    bool verified(const Task& task, std::uintmax_t bytes); // kopie ma velikost zdroje, zdroj lze smazat
+    std::string methodSummary() const; // napr. "reflink 3, copy_file_range 1"
+};
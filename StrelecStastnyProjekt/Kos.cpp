@@ -0,0 +1,287 @@
+﻿// Kos.cpp: Implementace Trash, viz Kos.h
+
+#include "Kos.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#endif
+
+// cesta v .trashinfo je zakodovana jako v URL
+static std::string percentEncode(const std::string& text) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || std::strchr("/._-~", c)) {
+            out.push_back(static_cast<char>(c));
+        }
+        else {
+            out += { '%', hex[c >> 4], hex[c & 15] };
+        }
+    }
+    return out;
+}
+
+// neplatne "%zz" z ciziho nebo poskozeneho .trashinfo se opise beze zmeny, nesmi shodit program
+static std::string percentDecode(const std::string& text) {
+    auto hex = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(static_cast<unsigned char>(c)) - 'a' + 10; };
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1]))
+            && std::isxdigit(static_cast<unsigned char>(text[i + 2]))) {
+            out.push_back(static_cast<char>(hex(text[i + 1]) * 16 + hex(text[i + 2])));
+            i += 2;
+        }
+        else {
+            out.push_back(text[i]);
+        }
+    }
+    return out;
+}
+
+// znacka polozek z tohoto programu; klice X- ostatni implementace kose ignoruji
+static const char* const ownerKey = "X-Spravce=true";
+
+static bool ownedItem(const fs::path& info) {
+    std::ifstream file(info);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line == ownerKey) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Trash::Trash() {
+    if (const char* days = std::getenv("SPRAVCE_KOS_DNY")) {
+        maxAge = std::chrono::seconds(static_cast<long long>(std::atof(days) * 24 * 3600));
+    }
+    if (const char* operations = std::getenv("SPRAVCE_KOS_OPERACI")) {
+        operationsPerSecond = std::max<size_t>(1, std::strtoul(operations, nullptr, 10));
+    }
+#ifdef __linux__
+    const char* home = std::getenv("HOME");
+    if (home) {
+        knownTrashes.insert(fs::path(home) / ".local/share/Trash");
+    }
+    purger = std::thread(&Trash::purgeLoop, this);
+#endif
+}
+
+Trash::~Trash() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (purger.joinable()) {
+        purger.join();
+    }
+}
+
+bool Trash::isTrashFiles(const fs::path& dir) {
+    fs::path trash = dir.parent_path();
+    std::string name = trash.filename().string();
+    return dir.filename() == "files" && (name == "Trash" || name.rfind(".Trash-", 0) == 0);
+}
+
+Trash::Item Trash::itemFor(const fs::path& stored) {
+    Item item;
+    item.stored = stored;
+    item.info = stored.parent_path().parent_path() / "info" / (stored.filename().string() + ".trashinfo");
+    std::ifstream in(item.info);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("Path=", 0) == 0) {
+            item.original = percentDecode(line.substr(5));
+        }
+    }
+    return item;
+}
+
+fs::path Trash::trashFor(const fs::path& path, std::string& error) {
+#ifdef __linux__
+    struct stat target {};
+    if (::lstat(path.c_str(), &target) != 0) {
+        error = std::strerror(errno);
+        return {};
+    }
+    struct stat st {};
+    const char* home = std::getenv("HOME");
+    fs::path trash;
+    if (home && ::stat(home, &st) == 0 && st.st_dev == target.st_dev) {
+        trash = fs::path(home) / ".local/share/Trash";
+    }
+    else {
+        fs::path top = fs::absolute(path).parent_path(); // koren svazku: nejvyssi predek se stejnym zarizenim
+        while (top.has_parent_path() && top != top.parent_path()
+            && ::stat(top.parent_path().c_str(), &st) == 0 && st.st_dev == target.st_dev) {
+            top = top.parent_path();
+        }
+        trash = top / (".Trash-" + std::to_string(::getuid()));
+    }
+    std::error_code ec;
+    fs::create_directories(trash / "files", ec);
+    fs::create_directories(trash / "info", ec);
+    if (ec || ::stat((trash / "files").c_str(), &st) != 0) {
+        error = "kos nelze vytvorit: " + (ec ? ec.message() : std::string(std::strerror(errno)));
+        return {};
+    }
+    ::chmod(trash.c_str(), 0700);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        knownTrashes.insert(trash);
+    }
+    return trash;
+#else
+    (void)path;
+    error = "kos neni k dispozici";
+    return {};
+#endif
+}
+
+bool Trash::moveToTrash(const fs::path& path, Item& item, std::string& error) {
+#ifdef __linux__
+    fs::path trash = trashFor(path, error);
+    if (trash.empty()) {
+        return false;
+    }
+    // jmeno v kosi se rezervuje vytvorenim .trashinfo s O_EXCL, dve stejna jmena se neprepisi
+    std::string base = path.filename().string();
+    int fd = -1;
+    for (int attempt = 1; fd < 0; ++attempt) {
+        std::string name = attempt == 1 ? base : base + "." + std::to_string(attempt);
+        item.stored = trash / "files" / name;
+        item.info = trash / "info" / (name + ".trashinfo");
+        fd = ::open(item.info.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0 && errno != EEXIST) {
+            error = std::strerror(errno);
+            return false;
+        }
+    }
+    item.original = fs::absolute(path);
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    std::string info = "[Trash Info]\nPath=" + percentEncode(item.original.string()) + "\nDeletionDate=" + date + "\n"
+        + ownerKey + "\n";
+    bool written = ::write(fd, info.data(), info.size()) == static_cast<ssize_t>(info.size());
+    ::close(fd);
+    if (written && ::rename(path.c_str(), item.stored.c_str()) == 0) {
+        return true;
+    }
+    error = written ? std::strerror(errno) : "nelze zapsat .trashinfo"; // EXDEV: napr. bind mount, kos je jinde
+    ::unlink(item.info.c_str());
+    return false;
+#else
+    (void)path;
+    (void)item;
+    error = "kos neni k dispozici";
+    return false;
+#endif
+}
+
+bool Trash::restore(const Item& item, std::string& error) {
+    std::error_code ec;
+    if (item.original.empty()) {
+        error = "chybi " + item.info.string();
+        return false;
+    }
+    if (fs::exists(fs::symlink_status(item.original, ec))) {
+        error = item.original.string() + " uz existuje";
+        return false;
+    }
+    fs::create_directories(item.original.parent_path(), ec); // puvodni slozka mezitim mohla zmizet
+    fs::rename(item.stored, item.original, ec);
+    if (ec) {
+        error = ec.message();
+        return false;
+    }
+    fs::remove(item.info, ec);
+    return true;
+}
+
+bool Trash::spend() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        auto now = std::chrono::steady_clock::now();
+        tokens = std::min<double>(static_cast<double>(operationsPerSecond),
+            tokens + std::chrono::duration<double>(now - refill).count() * operationsPerSecond);
+        refill = now;
+        if (tokens >= 1) {
+            tokens -= 1;
+            return true;
+        }
+        wake.wait_for(lock, std::chrono::milliseconds(1000 / operationsPerSecond + 1));
+    }
+    return false;
+}
+
+void Trash::purgeItem(const Item& item) {
+    // po jedne polozce, kazdy unlink a rmdir spotrebuje jednu operaci z rozpoctu
+    std::error_code ec;
+    std::vector<fs::path> paths{ item.stored };
+    if (fs::is_directory(fs::symlink_status(item.stored, ec))) {
+        for (fs::recursive_directory_iterator it(item.stored, ec), end; !ec && it != end; it.increment(ec)) {
+            paths.push_back(it->path());
+        }
+    }
+    for (auto it = paths.rbegin(); it != paths.rend(); ++it) {
+        if (!spend()) {
+            return; // konec programu, zbytek se dosmaze priste
+        }
+        fs::remove(*it, ec);
+    }
+    fs::remove(item.info, ec);
+}
+
+void Trash::purgeLoop() {
+#ifdef __linux__
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+    ::syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, 0, 3 << 13 /* IOPRIO_CLASS_IDLE */); // disk jen kdyz je volny
+#endif
+    while (true) {
+        std::set<fs::path> trashes;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            trashes = knownTrashes;
+        }
+        auto cutoff = fs::file_time_type::clock::now() - maxAge;
+        for (const auto& trash : trashes) {
+            std::error_code ec;
+            for (fs::directory_iterator it(trash / "info", ec), end; !ec && it != end; it.increment(ec)) {
+                // cas zapisu .trashinfo je cas smazani; vlastni chyba, aby jedna polozka neukoncila pruchod
+                std::error_code timeError;
+                if (it->path().extension() != ".trashinfo" || it->last_write_time(timeError) > cutoff || timeError
+                    || !ownedItem(it->path())) {
+                    continue;
+                }
+                Item item;
+                item.info = it->path();
+                item.stored = trash / "files" / it->path().stem();
+                purgeItem(item);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) {
+                    return;
+                }
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::minutes(10), [this] { return stopping; });
+    }
+}
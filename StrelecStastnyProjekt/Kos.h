@@ -0,0 +1,57 @@
+﻿// Kos.h: Kos podle freedesktop.org a jeho cisteni na pozadi.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Kos podle freedesktop.org: na kazdem svazku vlastni slozka (domovska ~/.local/share/Trash,
+// jinde <koren svazku>/.Trash-<uid>) s podslozkami files a info. Smazani je jedno rename na
+// stejnem svazku, tedy okamzite a vratne. Kdyz kos na svazku nejde vytvorit nebo rename vrati
+// EXDEV, polozka se do kose nepresune a volajici ji musi smazat trvale.
+// Vlakno s nejnizsi prioritou CPU i I/O trvale maze polozky starsi nez maxAge a nesmi prekrocit
+// zadany pocet operaci za sekundu (SPRAVCE_KOS_DNY, SPRAVCE_KOS_OPERACI). Maze jen polozky, ktere
+// do kose dal tento program (klic X-Spravce v .trashinfo), polozky jinych aplikaci nechava byt.
+struct Trash {
+    struct Item {
+        fs::path original; // kam se obnovi
+        fs::path stored;   // files/<jmeno>
+        fs::path info;     // info/<jmeno>.trashinfo
+    };
+
+    std::chrono::seconds maxAge{ 30 * 24 * 3600 };
+    size_t operationsPerSecond = 500; // unlink a rmdir pri cisteni
+    std::vector<std::vector<Item>> history; // davky presunute v tomto behu, klavesa b vraci posledni
+
+    Trash();
+    ~Trash();
+    Trash(const Trash&) = delete;
+    Trash& operator=(const Trash&) = delete;
+
+    bool moveToTrash(const fs::path& path, Item& item, std::string& error); // false: nutno smazat trvale
+    bool restore(const Item& item, std::string& error);
+    static bool isTrashFiles(const fs::path& dir); // slozka files nejakeho kose
+    static Item itemFor(const fs::path& stored);   // polozka v kosi podle cesty ve files
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::set<fs::path> knownTrashes; // kose, ktere se cisti
+    std::thread purger;
+
+    fs::path trashFor(const fs::path& path, std::string& error); // vytvori kos na svazku cesty
+    void purgeLoop();
+    void purgeItem(const Item& item);
+    bool spend(); // cekani na dalsi operaci v ramci rozpoctu, false pri ukonceni
+    double tokens = 0;
+    std::chrono::steady_clock::time_point refill = std::chrono::steady_clock::now();
+};
@@ -0,0 +1,210 @@
+﻿// MazaniStromu.cpp: Implementace DeleteEngine, viz MazaniStromu.h
+
+#include "MazaniStromu.h"
+#include "CteniSlozky.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <cstring>
+#include <cerrno>
+#endif
+
+DeleteEngine::Node::~Node() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
+
+void DeleteEngine::run(const std::vector<fs::path>& paths) {
+#ifdef __linux__
+    for (const auto& path : paths) {
+        auto parent = std::make_shared<Node>();
+        parent->location = path.parent_path().empty() ? fs::path(".") : path.parent_path();
+        parent->fd = ::open(parent->location.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (parent->fd < 0) {
+            job.addError(path, std::strerror(errno));
+            continue;
+        }
+        ++job.progress.filesTotal;
+        std::string name = path.filename().string();
+        if (::unlinkat(parent->fd, name.c_str(), 0) == 0) {
+            ++job.progress.filesDone; // soubor nebo odkaz, hotovo hned
+            continue;
+        }
+        if (errno != EISDIR && errno != EPERM) { // unlink slozky vraci na Linuxu EISDIR
+            job.addError(path, std::strerror(errno));
+            continue;
+        }
+        auto node = std::make_shared<Node>();
+        node->parent = parent;
+        node->name = name;
+        node->depth = parent->depth + 1;
+        ++parent->pending; // koren se nikdy nedokonci, jeho deskriptor se zavre s posledni referenci
+        ++pending;
+        queue.push_back(node);
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&DeleteEngine::worker, this);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    queue.clear(); // po zruseni: uvolnit uzly, deskriptory se zavrou
+#else
+    for (const auto& path : paths) { // bez deskriptoru slozek po jednotlivych cestach
+        std::error_code ec;
+        std::vector<fs::path> all{ path };
+        if (fs::is_directory(fs::symlink_status(path, ec))) {
+            for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+                all.push_back(it->path());
+                ++job.progress.filesTotal;
+            }
+        }
+        ++job.progress.filesTotal;
+        for (auto it = all.rbegin(); it != all.rend() && job.progress.checkpoint(); ++it) {
+            if (!fs::remove(*it, ec) && ec) {
+                job.addError(*it, ec.message());
+            }
+            ++job.progress.filesDone;
+        }
+    }
+#endif
+    job.progress.scanDone = true;
+}
+
+void DeleteEngine::worker() {
+    while (true) {
+        std::shared_ptr<Node> node;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return !queue.empty() || pending == 0 || job.progress.cancelled; });
+            if (queue.empty() || job.progress.cancelled) {
+                wake.notify_all();
+                return;
+            }
+            node = std::move(queue.back());
+            queue.pop_back();
+        }
+        removeContents(node);
+        finish(node);
+        if (--pending == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_all(); // vsechno smazano, ostatni vlakna skonci
+        }
+    }
+}
+
+void DeleteEngine::removeContents(const std::shared_ptr<Node>& node) {
+#ifdef __linux__
+    if (!job.progress.checkpoint()) {
+        return;
+    }
+    bool owned = false;
+    int parentFd = openParent(*node, owned);
+    node->fd = parentFd < 0 ? -1 : ::openat(parentFd, node->name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    int openError = errno;
+    if (owned) {
+        ::close(parentFd);
+    }
+    if (node->fd < 0) {
+        errno = openError;
+        job.addError(node->path(), std::strerror(errno));
+        return;
+    }
+    std::vector<char> buffer(256 * 1024);
+    long length;
+    while ((length = ::syscall(SYS_getdents64, node->fd, buffer.data(), buffer.size())) > 0) {
+        for (long offset = 0; offset < length; offset += reinterpret_cast<LinuxDirent64*>(buffer.data() + offset)->d_reclen) {
+            auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+            const char* name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+                continue;
+            }
+            bool directory = dirent->d_type == DT_DIR;
+            if (dirent->d_type == DT_UNKNOWN) {
+                struct stat st {};
+                directory = ::fstatat(node->fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+            }
+            ++job.progress.filesTotal;
+            if (directory) {
+                auto child = std::make_shared<Node>();
+                child->parent = node;
+                child->name = name;
+                child->depth = node->depth + 1;
+                ++node->pending;
+                ++pending;
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(std::move(child));
+                wake.notify_one();
+                continue;
+            }
+            if (::unlinkat(node->fd, name, 0) != 0) {
+                job.addError(node->path() / name, std::strerror(errno)); // chyba se zapise, maze se dal
+            }
+            ++job.progress.filesDone;
+        }
+        if (!job.progress.checkpoint()) {
+            break; // pauza ceka tady, po zruseni zustane slozka rozmazana
+        }
+    }
+    if (!node->keepsFd()) {
+        ::close(node->fd); // potomci se otevrou od predka, ktery deskriptor drzi
+        node->fd = -1;
+    }
+#else
+    (void)node;
+#endif
+}
+
+void DeleteEngine::finish(std::shared_ptr<Node> node) {
+#ifdef __linux__
+    while (node && node->parent && --node->pending == 0) {
+        if (!job.progress.cancelled) {
+            bool owned = false;
+            int parentFd = openParent(*node, owned);
+            if (parentFd < 0 || ::unlinkat(parentFd, node->name.c_str(), AT_REMOVEDIR) != 0) {
+                job.addError(node->path(), std::strerror(errno)); // napr. v ni zustal soubor, ktery nesel smazat
+            }
+            if (owned) {
+                ::close(parentFd);
+            }
+            ++job.progress.filesDone;
+        }
+        if (node->fd >= 0) {
+            ::close(node->fd);
+            node->fd = -1;
+        }
+        node = node->parent; // rodic mohl cekat jen na tuto slozku
+    }
+#else
+    (void)node;
+#endif
+}
+
+int DeleteEngine::openParent(const Node& node, bool& owned) {
+    owned = false;
+#ifdef __linux__
+    const Node* anchor = node.parent.get();
+    std::string below; // cesta od nejblizsiho predka s otevrenym deskriptorem k rodici
+    while (anchor->parent && !anchor->keepsFd()) {
+        below = below.empty() ? anchor->name : anchor->name + "/" + below;
+        anchor = anchor->parent.get();
+    }
+    if (below.empty()) {
+        return anchor->fd; // predek drzi deskriptor, dokud nedobehnou vsichni potomci
+    }
+    int fd = openBelow(anchor->fd, below);
+    owned = fd >= 0;
+    return fd;
+#else
+    (void)node;
+    return -1;
+#endif
+}
@@ -0,0 +1,57 @@
+﻿// MazaniStromu.h: Paralelni trvale mazani stromu slozek pro ulohy mazani.
+
+#pragma once
+
+#include "Ulohy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Rekurzivni mazani relativne k deskriptorum slozek: getdents64 a unlinkat, cela cesta se sklada
+// jen pro hlaseni chyby. Kazda slozka je uzel; podslozky se zpracovavaji paralelne z jedne fronty
+// (posledni napred, do hloubky). Posledni dokonceny potomek smaze rodice (rmdir) a pokracuje nahoru.
+// Uzly do hloubky openLevels a pak kazda openLevels-ta uroven (nejvyse openLevels krat) drzi
+// deskriptor, dokud nejsou smazani vsichni potomci. Ostatni slozky ho zavrou hned po precteni
+// a jejich potomci se otviraji cestou od nejblizsiho otevreneho predka, takze jedna vetev drzi
+// nejvyse 2 * openLevels deskriptoru bez ohledu na hloubku stromu.
+struct DeleteEngine {
+    struct Node {
+        std::shared_ptr<Node> parent; // nullptr jen u slozky, ve ktere mazane polozky lezi
+        std::string name;             // jmeno v rodicovske slozce
+        fs::path location;            // jen u korene: cela cesta
+        int fd = -1;
+        size_t depth = 0;             // koren 0
+        std::atomic<size_t> pending{ 1 }; // vlastni pruchod + nedokoncene podslozky
+        ~Node(); // zavre fd
+        fs::path path() const { return parent ? parent->path() / name : location; }
+        bool keepsFd() const {
+            return depth < openLevels || (depth % openLevels == 0 && depth < openLevels * openLevels);
+        }
+    };
+    static constexpr size_t openLevels = 64;
+
+    size_t workerCount;
+    std::deque<std::shared_ptr<Node>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{ 0 }; // slozky ve fronte nebo prave ctene
+    Job& job;
+
+    explicit DeleteEngine(Job& owner, size_t workers = 0)
+        : workerCount(workers ? workers : std::max<size_t>(2, std::min(16u, std::thread::hardware_concurrency() * 2))),
+        job(owner) {}
+
+    void run(const std::vector<fs::path>& paths); // vrati se az je vse smazano nebo zruseno
+    void worker();
+    void removeContents(const std::shared_ptr<Node>& node);
+    void finish(std::shared_ptr<Node> node); // odebere jeden nedokonceny dil, posledni smaze slozku
+    int openParent(const Node& node, bool& owned); // deskriptor rodice; owned: volajici ho zavre
+};
@@ -0,0 +1,503 @@
+﻿// MereniVykonu.cpp: Mereni rychlosti kritickych casti spravce souboru.
+//
+// Pouziti: MereniVykonu vypis <slozka> [pocet_polozek] [opakovani]
+//   Kdyz slozka neexistuje a je zadan pocet, vytvori se v ni tolik prazdnych souboru.
+//          MereniVykonu hledani <slozka> [pocet_souboru] [opakovani] [vzor]
+//   Porovna paralelni hledani s find(1); strom o pocet_souboru souborech se vytvori, kdyz chybi
+//   (pro mereni na NVMe napr. 10000000, po tisici souborech ve slozce).
+//          MereniVykonu schranka [pocet_cest]
+//   Pamet a cas schranky s pocet_cest soubory z jedne slozky proti std::set<fs::path>.
+//          MereniVykonu sada <slozka> [sirka] [hloubka] [velikost_souboru] [opakovani] [vetveni]
+//   Nacteni slozky, vykresleni radku, vlozeni (kopie) a smazani nad umelym stromem; na stdout
+//   vypise JSON s medianem, p99 a propustnosti, aby se dala porovnavat mereni mezi verzemi.
+
+#include "TabulkaPolozek.h"
+#include "CteniSlozky.h"
+#include "Formatovani.h"
+#include "Panel.h"
+#include "Schranka.h"
+#include "Hledani.h"
+#include "Ulohy.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <set>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <charconv>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// median casu v milisekundach z nekolika opakovani
+static double medianMs(int repeats, const std::function<size_t()>& body, size_t& count) {
+    std::vector<double> times;
+    for (int i = 0; i < std::max(repeats, 1); ++i) { // aspon jedno mereni, median prazdne rady neexistuje
+        auto start = std::chrono::steady_clock::now();
+        count = body();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void report(const char* name, double ms, size_t count) {
+    std::cout << std::left << std::setw(36) << name << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+        << ms << " ms" << std::setw(12) << count << " polozek" << std::setw(14) << static_cast<long long>(count / (ms / 1000.0))
+        << " polozek/s\n";
+}
+
+// obsazena pamet tabulky vcetne rezervy ve vectorech
+static size_t tableMemory(const EntryTable& table) {
+    return table.names.capacity() + table.nameOffsets.capacity() * sizeof(std::uint32_t) + table.nameLengths.capacity() * sizeof(std::uint16_t)
+        + table.flags.capacity() + table.sizes.capacity() * sizeof(std::uint64_t) + table.mtimes.capacity() * sizeof(std::int64_t);
+}
+
+// vytvori count prazdnych souboru, jen kdyz slozka jeste neexistuje
+static void createFlatDirectory(const std::string& dir, size_t count) {
+    if (fs::exists(dir) || count == 0) {
+        return;
+    }
+    fs::create_directories(dir);
+    std::cout << "Vytvarim " << count << " souboru v " << dir << "...\n";
+    char name[32];
+    for (size_t i = 0; i < count; ++i) {
+        std::snprintf(name, sizeof(name), "/soubor%08zu.log", i);
+        std::ofstream(dir + name);
+    }
+}
+
+static int benchmarkListing(const std::string& dir, int repeats) {
+    size_t count = 0;
+    std::cout << "Vypis slozky " << dir << ", median z " << repeats << " opakovani\n";
+
+    // puvodni refreshEntries: directory_iterator a typ, velikost a cas pro kazdou polozku
+    double ms = medianMs(repeats, [&] {
+        std::vector<fs::directory_entry> entries;
+        std::vector<EntryInfo> infos;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            entries.push_back(entry);
+            infos.push_back(loadInfo(entry));
+        }
+        return entries.size();
+    }, count);
+    report("directory_iterator + stat", ms, count);
+
+    ms = medianMs(repeats, [&] {
+        std::vector<std::string> names;
+        std::vector<EntryInfo> infos;
+        std::string error;
+        enumerateDirectory(dir, [&](std::string_view name, const EntryInfo& info) {
+            names.emplace_back(name);
+            infos.push_back(info);
+            return true;
+        }, error);
+        return names.size();
+    }, count);
+    report("getdents64 + d_type", ms, count);
+
+    // s metadaty pro vsechny polozky, jako pri razeni podle velikosti
+    ms = medianMs(repeats, [&] {
+        FilePanel panel(dir);
+        while (panel.loading()) {
+            panel.pollScan();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        panel.ensureMetadata(0, panel.entries.size());
+        return panel.entries.size();
+    }, count);
+    report("FilePanel::refreshEntries + statx", ms, count);
+
+    size_t tableBytes = 0;
+    ms = medianMs(repeats, [&] {
+        FilePanel panel(dir);
+        while (panel.loading()) {
+            panel.pollScan();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        tableBytes = tableMemory(panel.entries);
+        return panel.entries.size();
+    }, count);
+    report("FilePanel::refreshEntries", ms, count);
+    std::cout << "Pamet tabulky polozek: " << tableBytes / std::max<size_t>(count, 1) << " B na polozku\n";
+
+    // razeni jiz nactene tabulky, bez dotazu na disk
+    FilePanel panel(dir);
+    while (panel.loading()) {
+        panel.pollScan();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const std::pair<FilePanel::SortMode, const char*> modes[] = { { FilePanel::SortMode::Name, "razeni podle jmena" },
+        { FilePanel::SortMode::Natural, "razeni prirozene" }, { FilePanel::SortMode::Size, "razeni podle velikosti" },
+        { FilePanel::SortMode::Modified, "razeni podle casu" }, { FilePanel::SortMode::Extension, "razeni podle pripony" } };
+    for (const auto& [mode, name] : modes) {
+        panel.setSortMode(mode, false);
+        ms = medianMs(repeats, [&] {
+            panel.sortEntries();
+            return panel.order.size();
+        }, count);
+        report(name, ms, count);
+    }
+
+    // filtr pri psani nad milionem jmen v pameti: prvni znak projde arenu, dalsi jen minuly vysledek
+    const char* words[] = { "zprava", "Faktura", "foto", "zaloha", "Projekt", "data", "poznamky", "video" };
+    panel.entries.clear();
+    char name[64];
+    for (size_t i = 0; i < 1000000; ++i) {
+        std::snprintf(name, sizeof(name), "%s_%07zu.%s", words[i % 8], i, (i % 3) ? "txt" : "JPG");
+        panel.entries.push(name, EntryInfo());
+    }
+    panel.order.resize(panel.entries.size());
+    for (size_t i = 0; i < panel.order.size(); ++i) {
+        panel.order[i] = static_cast<std::uint32_t>(i);
+    }
+    const char* typed = "kt_001";
+    for (size_t length = 1; length <= std::strlen(typed); ++length) {
+        std::vector<double> times; // meri se jen posledni znak, predchozi jsou priprava
+        size_t candidates = 0;     // kolik jmen se prochazi
+        for (int r = 0; r < repeats; ++r) {
+            panel.clearFilter();
+            for (size_t i = 0; i + 1 < length; ++i) {
+                panel.appendFilter(typed[i]);
+            }
+            candidates = panel.visible().size();
+            auto start = std::chrono::steady_clock::now();
+            panel.appendFilter(typed[length - 1]);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        std::string label = std::string("filtr \"") + std::string(typed, length) + "\" (" + std::to_string(panel.visible().size()) + " shod)";
+        report(label.c_str(), times[times.size() / 2], candidates);
+    }
+    return 0;
+}
+
+// strom slozek d000/d000 po tisici souborech, ctvrtina souboru ma priponu .log
+static void createTree(const std::string& dir, size_t count) {
+    if (fs::exists(dir) || count == 0) {
+        return;
+    }
+    std::cout << "Vytvarim strom s " << count << " soubory v " << dir << "...\n";
+    char path[64];
+    for (size_t i = 0; i < count; ++i) {
+        size_t leaf = i / 1000;
+        if (i % 1000 == 0) {
+            std::snprintf(path, sizeof(path), "/d%03zu/d%03zu", leaf / 1000, leaf % 1000);
+            fs::create_directories(dir + path);
+        }
+        std::snprintf(path, sizeof(path), "/d%03zu/d%03zu/soubor%06zu.%s", leaf / 1000, leaf % 1000, i % 1000, i % 4 ? "txt" : "log");
+        std::ofstream(dir + path);
+    }
+}
+
+static int benchmarkFind(const std::string& dir, int repeats, const std::string& pattern) {
+    size_t count = 0;
+    std::cout << "Hledani \"" << pattern << "\" v " << dir << ", median z " << repeats << " opakovani\n";
+    double ms = medianMs(repeats, [&] {
+        std::string command = "find '" + dir + "' -name '" + pattern + "' | wc -l";
+        FILE* pipe = ::popen(command.c_str(), "r");
+        unsigned long found = 0;
+        if (pipe) {
+            if (std::fscanf(pipe, "%lu", &found) != 1) {
+                found = 0;
+            }
+            ::pclose(pipe);
+        }
+        return static_cast<size_t>(found);
+    }, count);
+    report("find(1) -name", ms, count);
+
+    FindQuery query;
+    query.pattern = pattern;
+    std::atomic<bool> cancelled{ false };
+    size_t scanned = 0;
+    for (size_t threads : { size_t(1), ParallelFind::threadsFor(dir) }) {
+        ms = medianMs(repeats, [&] {
+            std::atomic<size_t> found{ 0 };
+            ParallelFind find(query, dir, cancelled, [&](EntryTable& batch) { found += batch.size(); });
+            find.run(threads);
+            scanned = find.scanned;
+            return found.load();
+        }, count);
+        std::string label = "ParallelFind, vlaken: " + std::to_string(threads);
+        report(label.c_str(), ms, count);
+    }
+    std::cout << "Prohledano polozek: " << scanned << "\n";
+    return 0;
+}
+
+// obsazena pamet haldy, jen s glibc
+static size_t heapBytes() {
+#ifdef __GLIBC__
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static int benchmarkClipboard(size_t count) {
+    std::cout << "Schranka s " << count << " cestami z jedne slozky\n";
+    const std::string dir = "/home/uzivatel/data/fotky/2024";
+    char name[32];
+    size_t before = heapBytes();
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::set<fs::path> files; // puvodni schranka
+        for (size_t i = 0; i < count; ++i) {
+            std::snprintf(name, sizeof(name), "IMG_%07zu.jpg", i);
+            files.insert(fs::path(dir) / name);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        report("std::set<fs::path> vlozeni", ms, files.size());
+        std::cout << "  pamet: " << (heapBytes() - before) / std::max<size_t>(count, 1) << " B na cestu\n";
+    }
+    before = heapBytes();
+    start = std::chrono::steady_clock::now();
+    Clipboard clipboard;
+    for (size_t i = 0; i < count; ++i) {
+        std::snprintf(name, sizeof(name), "IMG_%07zu.jpg", i);
+        clipboard.add(dir, name);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    report("Clipboard vlozeni", ms, clipboard.count);
+    std::cout << "  pamet: " << (heapBytes() - before) / std::max<size_t>(count, 1) << " B na cestu\n";
+    start = std::chrono::steady_clock::now();
+    size_t pasted = clipboard.paths().size();
+    report("Clipboard::paths (vlozeni)", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), pasted);
+    return 0;
+}
+
+// Tvar umeleho stromu: v kazde slozce width souboru o fileSize bajtech a fanout podslozek do hloubky depth
+struct TreeShape {
+    size_t width = 1000;
+    size_t depth = 2;
+    size_t fileSize = 4096;
+    size_t fanout = 4;
+
+    size_t dirs() const {
+        size_t total = 0;
+        for (size_t level = 0, atLevel = 1; level <= depth; ++level, atLevel *= fanout) {
+            total += atLevel;
+        }
+        return total;
+    }
+    size_t files() const { return dirs() * width; }
+};
+
+static void createShapedTree(const fs::path& dir, const TreeShape& shape, const std::string& content, size_t level) {
+    fs::create_directories(dir);
+    char name[32];
+    for (size_t i = 0; i < shape.width; ++i) {
+        std::snprintf(name, sizeof(name), "soubor%06zu.dat", i);
+        std::ofstream(dir / name, std::ios::binary).write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    for (size_t i = 0; level < shape.depth && i < shape.fanout; ++i) {
+        std::snprintf(name, sizeof(name), "slozka%03zu", i);
+        createShapedTree(dir / name, shape, content, level + 1);
+    }
+}
+
+// Vysledek jedne casti sady: casy jednotlivych opakovani a kolik prace kazde udelalo
+struct SuiteResult {
+    std::string name{};
+    std::vector<double> times{}; // ms
+    size_t items = 0;          // polozek na jedno opakovani
+    std::uintmax_t bytes = 0;  // bajtu na jedno opakovani, 0 kdyz se nemeri
+};
+
+// percentil metodou nejblizsiho poradi, times musi byt serazene
+static double percentile(const std::vector<double>& times, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * times.size()));
+    return times[std::min(times.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static void writeJson(std::ostream& out, const TreeShape& shape, std::vector<SuiteResult>& results) {
+    char number[64];
+    out << "{\n  \"tree\": { \"width\": " << shape.width << ", \"depth\": " << shape.depth << ", \"fanout\": " << shape.fanout
+        << ", \"file_size\": " << shape.fileSize << ", \"files\": " << shape.files() << ", \"dirs\": " << shape.dirs() << " },\n";
+    out << "  \"results\": [";
+    for (size_t r = 0; r < results.size(); ++r) {
+        SuiteResult& result = results[r];
+        std::sort(result.times.begin(), result.times.end());
+        double median = percentile(result.times, 50);
+        out << (r ? ",\n" : "\n") << "    { \"name\": \"" << result.name << "\", \"samples\": " << result.times.size();
+        std::snprintf(number, sizeof(number), "%.3f", median);
+        out << ", \"median_ms\": " << number;
+        std::snprintf(number, sizeof(number), "%.3f", percentile(result.times, 99));
+        out << ", \"p99_ms\": " << number << ", \"items\": " << result.items;
+        std::snprintf(number, sizeof(number), "%.0f", median > 0 ? result.items / (median / 1000.0) : 0.0);
+        out << ", \"items_per_s\": " << number;
+        if (result.bytes) {
+            std::snprintf(number, sizeof(number), "%.0f", median > 0 ? result.bytes / (median / 1000.0) : 0.0);
+            out << ", \"bytes\": " << result.bytes << ", \"bytes_per_s\": " << number;
+        }
+        out << " }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// uloha bezi na pracovnim vlakne fronty stejne jako po klavese v nebo L, ceka se na jeji konec
+static void runJob(JobQueue& jobs, Job::Kind kind, const fs::path& source, const fs::path& target = {}) {
+    auto job = jobs.submit(kind, { source }, target);
+    while (job->state != Job::State::Finished) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    if (!job->errors.empty()) {
+        std::cerr << "Chyba ulohy: " << job->errors.front() << "\n";
+    }
+    jobs.takeFinished();
+}
+
+static int benchmarkSuite(const fs::path& base, TreeShape shape, int repeats) {
+    char name[96];
+    std::snprintf(name, sizeof(name), "strom_s%zu_h%zu_v%zu_b%zu", shape.width, shape.depth, shape.fanout, shape.fileSize);
+    const fs::path tree = base / name;
+    if (!fs::exists(tree)) { // stejny tvar se pri dalsim mereni pouzije znovu
+        std::cerr << "Vytvarim " << shape.files() << " souboru v " << tree.string() << "...\n";
+        createShapedTree(tree, shape, std::string(shape.fileSize, 'x'), 0);
+    }
+    std::vector<SuiteResult> results;
+
+    // nacteni korene stromu: getdents64 na vlakne skenu a predani davek panelu (refreshEntries)
+    SuiteResult scan{ "scan" };
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        FilePanel panel(tree.string());
+        while (panel.loading()) {
+            panel.pollScan();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        scan.times.push_back(elapsedMs(start));
+        scan.items = panel.entries.size();
+    }
+    results.push_back(scan);
+
+    // vykresleni: snimky po 50 radcich pres cely seznam, text jde do /dev/null misto na terminal
+    SuiteResult render{ "render" };
+    {
+        FilePanel panel(tree.string());
+        while (panel.loading()) {
+            panel.pollScan();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        panel.ensureMetadata(0, panel.entries.size()); // stat se meri ve scan, tady jen formatovani
+        ColumnFormatter columns;
+        columns.now = std::time(nullptr);
+        std::FILE* sink = std::fopen("/dev/null", "wb");
+        const size_t frameRows = 50;
+        std::string out;
+        size_t frames = std::max<size_t>(1, (panel.visible().size() + frameRows - 1) / frameRows);
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t f = 0; f < frames; ++f) {
+                panel.scrollOffset = f * frameRows;
+                panel.selectedIndex = static_cast<int>(panel.scrollOffset);
+                auto start = std::chrono::steady_clock::now();
+                out.clear();
+                for (size_t row = 0; row <= frameRows; ++row) { // radek 0 je hlavicka s cestou
+                    panel.displayRow(out, row, true, 60, columns);
+                    out += '\n';
+                }
+                if (sink) {
+                    std::fwrite(out.data(), 1, out.size(), sink);
+                }
+                render.times.push_back(elapsedMs(start));
+            }
+        }
+        render.items = frameRows + 1; // radku na snimek
+        if (sink) {
+            std::fclose(sink);
+        }
+    }
+    results.push_back(render);
+
+    // vlozeni ze schranky a trvale smazani cele kopie, obe jako ulohy na pozadi
+    SuiteResult copy{ "copy" };
+    SuiteResult remove{ "delete" };
+    copy.items = remove.items = shape.files() + shape.dirs();
+    copy.bytes = static_cast<std::uintmax_t>(shape.files()) * shape.fileSize;
+    const fs::path target = base / "kopie";
+    fs::remove_all(target);
+    fs::create_directories(target);
+    {
+        JobQueue jobs;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            runJob(jobs, Job::Kind::Copy, tree, target);
+            copy.times.push_back(elapsedMs(start));
+            start = std::chrono::steady_clock::now();
+            runJob(jobs, Job::Kind::Delete, target / tree.filename());
+            remove.times.push_back(elapsedMs(start));
+        }
+    }
+    fs::remove_all(target);
+    results.push_back(copy);
+    results.push_back(remove);
+
+    writeJson(std::cout, shape, results);
+    return 0;
+}
+
+// volitelny ciselny argument; chybejici necha vychozi hodnotu, jiny text nez cislo vrati false
+// (std::stoul by na nem vyhodil vyjimku a program by skoncil bez napovedy)
+static bool numberArg(const std::vector<std::string>& args, size_t index, size_t& value) {
+    if (index >= args.size()) {
+        return true;
+    }
+    const std::string& text = args[index];
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    const int maxRepeats = 1000000;
+    if (args.size() >= 2 && args[0] == "vypis") {
+        size_t count = 0;
+        size_t repeats = 5;
+        if (numberArg(args, 2, count) && numberArg(args, 3, repeats)) {
+            createFlatDirectory(args[1], count);
+            return benchmarkListing(args[1], static_cast<int>(std::clamp<size_t>(repeats, 1, maxRepeats)));
+        }
+    }
+    else if (args.size() >= 2 && args[0] == "hledani") {
+        size_t count = 0;
+        size_t repeats = 5;
+        if (numberArg(args, 2, count) && numberArg(args, 3, repeats)) {
+            createTree(args[1], count);
+            return benchmarkFind(args[1], static_cast<int>(std::clamp<size_t>(repeats, 1, maxRepeats)),
+                args.size() >= 5 ? args[4] : "*.log");
+        }
+    }
+    else if (!args.empty() && args[0] == "schranka") {
+        size_t count = 1000000;
+        if (numberArg(args, 1, count)) {
+            return benchmarkClipboard(count);
+        }
+    }
+    else if (args.size() >= 2 && args[0] == "sada") {
+        TreeShape shape;
+        size_t repeats = 10;
+        if (numberArg(args, 2, shape.width) && numberArg(args, 3, shape.depth) && numberArg(args, 4, shape.fileSize)
+            && numberArg(args, 5, repeats) && numberArg(args, 6, shape.fanout)) {
+            return benchmarkSuite(args[1], shape, static_cast<int>(std::clamp<size_t>(repeats, 1, maxRepeats)));
+        }
+    }
+    std::cerr << "Pouziti: MereniVykonu vypis <slozka> [pocet_polozek] [opakovani]\n"
+        << "        MereniVykonu hledani <slozka> [pocet_souboru] [opakovani] [vzor]\n"
+        << "        MereniVykonu schranka [pocet_cest]\n"
+        << "        MereniVykonu sada <slozka> [sirka] [hloubka] [velikost_souboru] [opakovani] [vetveni]\n";
+    return 1;
+}
@@ -0,0 +1,1201 @@
+﻿// Panel.cpp: Implementace FilePanel, viz Panel.h
+
+#include "Panel.h"
+#include "Formatovani.h"
+#include "HledaniBajtu.h"
+#include "Hledani.h"
+#include "HledaniTextu.h"
+#include "VelikostiSlozek.h"
+#include "Kos.h"
+#include "Ulohy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// implementace FilePanel
+std::shared_ptr<DirectoryScan> FilePanel::beginScan() {
+    if (scan) {
+        scan->cancelled = true; // stare nacitani dobehne naprazdno, na vysledek se neceka
+    }
+    entries.clear();
+    order.clear();
+    sortKeys.clear();
+    filter.clear(); // filtr plati jen pro jednu slozku
+    filtered.clear();
+    scanError.clear();
+    selection.clear(); // bity patri k indexum stare tabulky
+    selectedCount = 0;
+    selectionAnchor = -1;
+    scan = std::make_shared<DirectoryScan>();
+    return scan;
+}
+
+FilePanel::~FilePanel() {
+    for (auto& scanThread : scanThreads) {
+        scanThread.state->cancelled = true;
+    }
+    for (auto& scanThread : scanThreads) {
+        scanThread.thread.join();
+    }
+}
+
+// pomaly NFS nesmi zdrzet ani prechod do jine slozky: zrusene nacitani dobehne samo a pripoji se pozdeji
+void FilePanel::launchScan(const std::shared_ptr<DirectoryScan>& state, std::function<void()> body) {
+    joinFinishedScans();
+    scanThreads.push_back({ std::thread([state, body = std::move(body)] {
+        body();
+        state->exited = true;
+    }), state });
+}
+
+void FilePanel::joinFinishedScans() {
+    for (auto it = scanThreads.begin(); it != scanThreads.end();) {
+        if (it->state->exited) {
+            it->thread.join();
+            it = scanThreads.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void FilePanel::startFind(const FindQuery& query, const std::string& text) {
+    storeListing(); // p z vysledku se vrati do slozky bez noveho cteni
+    watcher.watch(std::string()); // vysledky jsou z cele podslozky, inotify hlida jen jednu slozku
+    searchText = text;
+    selectedIndex = 0;
+    scrollOffset = 0;
+    std::shared_ptr<DirectoryScan> state = beginScan();
+    launchScan(state, [state, query, root = currentPath] {
+        ParallelFind find(query, root, state->cancelled, [&](EntryTable& batch) {
+            state->loaded += batch.size();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->entries.append(batch);
+        });
+        find.run(ParallelFind::threadsFor(root));
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (find.errors) {
+            state->error = std::to_string(find.errors.load()) + " slozek neslo precist";
+        }
+        state->done = true;
+    });
+}
+
+void FilePanel::cancelScan() {
+    if (!scan) {
+        return;
+    }
+    scan->cancelled = true;
+    {
+        std::lock_guard<std::mutex> lock(scan->mutex);
+        scan->done = true; // co uz prislo, se jeste prevezme
+        scan->error = searchText.empty() ? "nacitani preruseno" : "hledani preruseno";
+    }
+    pollScan();
+    joinFinishedScans();
+}
+
+void FilePanel::refreshEntries() {
+    watcher.watch(currentPath); // hlidat driv nez se zacne cist, at se neztrati zmena behem cteni
+    if (searchText.empty() && selectedCount) { // obnoveni teze slozky vyber nezrusi
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (isSelected(i)) {
+                reselectNames.emplace_back(entries.name(i));
+            }
+        }
+    }
+    searchText.clear();
+    std::shared_ptr<DirectoryScan> state = beginScan();
+    launchScan(state, [state, path = currentPath, withMetadata = sortNeedsMetadata()] {
+        auto lastFlush = std::chrono::steady_clock::now();
+        EntryTable entries;
+        auto flush = [&] {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->entries.append(entries);
+            entries = EntryTable();
+            lastFlush = std::chrono::steady_clock::now();
+        };
+        std::string error;
+        bool complete = enumerateDirectory(path, [&](std::string_view name, const EntryInfo& info) {
+            if (state->cancelled) {
+                return false;
+            }
+            entries.push(name, info);
+            ++state->loaded;
+            // prvni obrazovka hned, dale po davkach nebo aspon kazdych 50 ms
+            if (state->loaded == 64 || entries.size() >= 4096
+                || std::chrono::steady_clock::now() - lastFlush > std::chrono::milliseconds(50)) {
+                flush();
+            }
+            return true;
+        }, error, withMetadata);
+        if (!complete && state->cancelled) {
+            return;
+        }
+        flush();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->error = error;
+        state->done = true;
+    });
+}      // kdyby nastala chyba
+
+bool FilePanel::pollScan() {
+    if (!scan) {
+        return false;
+    }
+    bool changed = false;
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(scan->mutex);
+        changed = !scan->entries.empty();
+        if (entries.empty()) {
+            std::swap(entries, scan->entries); // prvni davka se jen prevezme
+        }
+        else {
+            entries.append(scan->entries);
+        }
+        scan->entries.clear();
+        done = scan->done;
+        scanError = scan->error;
+    }
+    for (size_t i = order.size(); i < entries.size(); ++i) {
+        order.push_back(static_cast<std::uint32_t>(i)); // behem nacitani v poradi, jak prichazi
+    }
+    if (!done && !filter.empty()) {
+        refilter();
+    }
+    if (done) {
+        scan.reset();
+        sortEntries(); // klice se spocitaji jednou nad celym seznamem
+        if (selectedIndex >= static_cast<int>(visible().size())) {
+            selectedIndex = visible().empty() ? 0 : static_cast<int>(visible().size()) - 1; // polozky mohly ubyt
+        }
+        changed = applyWatchEvents() || changed; // zmeny behem nacitani se zapracuji az nad celym seznamem
+        if (!cursorName.empty()) {
+            selectName(cursorName);
+            cursorName.clear();
+        }
+        if (!reselectNames.empty()) {
+            std::unordered_set<std::string_view> names(reselectNames.begin(), reselectNames.end());
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (names.count(entries.name(i))) {
+                    setSelected(i, true);
+                }
+            }
+            reselectNames.clear();
+        }
+    }
+    return changed;
+}
+
+void FilePanel::openDirectory(const std::string& path, const std::string& cursor) {
+    storeListing();
+    currentPath = path;
+    selectedIndex = 0;
+    scrollOffset = 0;
+    cursorName.clear();
+    if (restoreListing()) {
+        if (!cursor.empty()) {
+            selectName(cursor);
+        }
+        return;
+    }
+    refreshEntries();
+    if (!cursor.empty()) {
+        cursorName = cursor; // kurzor se nastavi az bude seznam kompletni
+    }
+}
+
+void FilePanel::storeListing() {
+    if (loading() || !searchText.empty() || entries.empty()) {
+        return; // jen kompletni obsah slozky
+    }
+    DirectoryStamp stamp = DirectoryStamp::of(currentPath); // driv nez se prectou posledni udalosti
+    applyWatchEvents();
+    if (loading() || !stamp.valid || entries.size() > listingCacheEntries) {
+        return; // pretekla fronta inotify, seznam se znovu nacita
+    }
+    CachedListing listing;
+    listing.path = currentPath;
+    listing.stamp = stamp;
+    listing.sortMode = sortMode;
+    listing.sortDescending = sortDescending;
+    std::int64_t selected = selectedTableIndex();
+    if (selected >= 0) {
+        listing.cursor = std::string(entries.name(static_cast<size_t>(selected)));
+    }
+    listing.entries = std::move(entries);
+    listing.order = std::move(order);
+    listing.sortKeys = std::move(sortKeys);
+    entries = EntryTable();
+    order.clear();
+    sortKeys.clear();
+    filter.clear();
+    filtered.clear();
+    clearSelection();
+    listingCache.remove_if([&](const CachedListing& cached) { return cached.path == listing.path; });
+    listingCache.push_front(std::move(listing));
+    size_t total = 0;
+    for (auto it = listingCache.begin(); it != listingCache.end();) {
+        total += it->entries.size();
+        if (static_cast<size_t>(std::distance(listingCache.begin(), it)) >= listingCacheSlots || total > listingCacheEntries) {
+            total -= it->entries.size();
+            it = listingCache.erase(it); // nejdele nepouzite
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+bool FilePanel::restoreListing() {
+    auto it = std::find_if(listingCache.begin(), listingCache.end(),
+        [&](const CachedListing& cached) { return cached.path == currentPath; });
+    if (it == listingCache.end()) {
+        return false;
+    }
+    CachedListing listing = std::move(*it);
+    listingCache.erase(it); // panel si seznam bere, pri odchodu ho vrati
+    watcher.watch(currentPath); // driv nez se porovna otisk: zmeny potom uz prijdou z inotify
+    if (!listing.stamp.matches(DirectoryStamp::of(currentPath))) {
+        return false;
+    }
+    if (scan) {
+        scan->cancelled = true;
+        scan.reset();
+    }
+    searchText.clear();
+    filter.clear();
+    filtered.clear();
+    scanError.clear();
+    clearSelection();
+    entries = std::move(listing.entries);
+    order = std::move(listing.order);
+    sortKeys = std::move(listing.sortKeys);
+    // zmena obsahu souboru slozku nezmeni, velikost a cas se pri zobrazeni nactou znovu
+    for (auto& flag : entries.flags) {
+        flag &= static_cast<std::uint8_t>(~(EntryTable::MetaLoaded | EntryTable::SizeKnown | EntryTable::TimeKnown | EntryTable::SizePartial));
+    }
+    if (sortNeedsMetadata()) {
+        ensureMetadata(order, 0, order.size());
+    }
+    if (sortNeedsMetadata() || listing.sortMode != sortMode || listing.sortDescending != sortDescending) {
+        sortEntries();
+    }
+    selectName(listing.cursor);
+    return true;
+}
+
+void FilePanel::selectName(std::string_view name) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries.name(i) == name) {
+            selectTableIndex(static_cast<std::int64_t>(i));
+            return;
+        }
+    }
+}
+
+bool FilePanel::applyWatchEvents() {
+    if (loading()) {
+        return false; // udalosti pockaji ve fronte inotify, nez bude seznam kompletni
+    }
+    std::vector<DirectoryWatcher::Event> events;
+    if (!watcher.readEvents(events)) {
+        refreshEntries(); // fronta pretekla, nektere zmeny chybi, nezbyva nez cely pruchod
+        return true;
+    }
+    if (events.empty()) {
+        return false;
+    }
+    if (std::any_of(events.begin(), events.end(), [](const DirectoryWatcher::Event& event) { return event.type == DirectoryWatcher::Event::Gone; })) {
+        // zobrazena slozka byla smazana nebo presunuta: seznam neplati, panel prejde na nejblizsi existujici predka
+        fs::path gone = currentPath;
+        fs::path parent = gone.parent_path();
+        std::error_code ec;
+        while (parent.has_relative_path() && !fs::is_directory(parent, ec)) {
+            gone = parent;
+            parent = parent.parent_path();
+        }
+        entries.clear(); // storeListing neulozi neplatny seznam do cache
+        openDirectory(parent.empty() ? std::string("/") : parent.string(), gone.filename().string());
+        clearSelection();
+        return true;
+    }
+    std::unordered_map<std::string_view, size_t> index; // jmeno v arene -> pozice, jen pro tuto davku udalosti
+    index.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        index.emplace(entries.name(i), i);
+    }
+    std::vector<bool> removed(entries.size(), false);
+    std::vector<bool> modified(entries.size(), false);
+    std::unordered_map<std::string, EntryInfo> added; // nove polozky se pridaji az po zhusteni areny
+    for (const auto& event : events) {
+        auto found = index.find(event.name);
+        if (event.type == DirectoryWatcher::Event::Removed) {
+            if (found != index.end()) {
+                removed[found->second] = true;
+                index.erase(found);
+            }
+            added.erase(event.name);
+            continue;
+        }
+        std::error_code ec;
+        fs::directory_entry entry(fs::path(currentPath) / event.name, ec);
+        if (ec || !entry.exists(ec)) {
+            continue; // mezitim zase zmizel, prijde i udalost o smazani
+        }
+        EntryInfo info = loadInfo(entry);
+        if (found != index.end()) {
+            entries.setInfo(found->second, info); // zmena nebo znovu vytvoreny soubor
+            modified[found->second] = true;
+        }
+        else {
+            added[event.name] = info;
+        }
+    }
+    // smazane polozky se odstrani jednim pruchodem, kurzor zustane na stejne polozce
+    std::int64_t selected = selectedTableIndex();
+    std::vector<std::uint32_t> remap(removed.size());
+    std::uint32_t kept = 0;
+    for (size_t i = 0; i < removed.size(); ++i) {
+        remap[i] = kept;
+        if (!removed[i]) {
+            if (kept != i) {
+                sortKeys[kept] = sortKeys[i];
+            }
+            ++kept;
+        }
+    }
+    sortKeys.resize(kept);
+    std::vector<std::uint32_t> reinsert; // pri razeni podle velikosti/casu se zmenena polozka presune
+    size_t position = 0;
+    int newSelected = selectedIndex;
+    for (size_t i = 0; i < order.size(); ++i) {
+        std::uint32_t old = order[i];
+        if (removed[old] || (modified[old] && sortNeedsMetadata())) {
+            if (filter.empty() && static_cast<int>(i) < selectedIndex) {
+                --newSelected;
+            }
+            if (!removed[old]) {
+                reinsert.push_back(remap[old]);
+            }
+            continue;
+        }
+        order[position++] = remap[old];
+    }
+    order.resize(position);
+    if (selected >= 0) {
+        selected = removed[selected] ? -1 : remap[selected];
+    }
+    index.clear(); // pohledy do areny po zhusteni neplati
+    if (selectedCount) {
+        std::vector<std::uint64_t> kept((removed.size() + 63) / 64);
+        selectedCount = 0;
+        for (size_t i = 0; i < removed.size(); ++i) {
+            if (!removed[i] && isSelected(i)) {
+                kept[remap[i] / 64] |= std::uint64_t(1) << (remap[i] % 64);
+                ++selectedCount;
+            }
+        }
+        selection.swap(kept);
+    }
+    if (selectionAnchor >= 0) {
+        selectionAnchor = removed[selectionAnchor] ? -1 : remap[selectionAnchor];
+    }
+    entries.compact(removed);
+    for (const auto& [name, info] : added) {
+        entries.push(name, info);
+        reinsert.push_back(static_cast<std::uint32_t>(entries.size() - 1));
+    }
+    for (std::uint32_t i : reinsert) {
+        if (i < sortKeys.size()) {
+            sortKeys[i] = computeSortKey(i);
+        }
+        else {
+            sortKeys.push_back(computeSortKey(i));
+        }
+        insertSorted(i);
+    }
+    selectedIndex = newSelected;
+    if (!filter.empty()) {
+        refilter();
+    }
+    selectTableIndex(selected); // presne dohledani, vlozene polozky mohly kurzor posunout
+    return true;
+}
+
+void FilePanel::ensureMetadata(size_t first, size_t last) {
+    ensureMetadata(visible(), first, last);
+}
+
+void FilePanel::ensureMetadata(const std::vector<std::uint32_t>& indices, size_t first, size_t last) {
+#ifdef __linux__
+    last = std::min(last, indices.size());
+    int dirfd = -1;
+    for (size_t position = first; position < last; ++position) {
+        size_t i = indices[position];
+        if (entries.metaLoaded(i)) {
+            continue; // kazda polozka se dotazuje nejvys jednou
+        }
+        if (dirfd < 0 && (dirfd = ::open(currentPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+            return;
+        }
+        EntryInfo info = entries.info(i);
+        statEntry(dirfd, entries.cname(i), info);
+        entries.setInfo(i, info);
+    }
+    if (dirfd >= 0) {
+        ::close(dirfd);
+    }
+#else
+    (void)indices;
+    (void)first;
+    (void)last; // mimo Linux se vse nacte uz pri vyctu
+#endif
+}
+
+// Razeni: kazda polozka ma retezec bajtu (sortString), jehoz lexikograficke poradi je stejne
+// jako lessEntry. Prvnich 7 bajtu tvori 64bitovy klic (bit 63 = neni slozka) pro radix sort,
+// polozky se shodnym klicem se doradi dalsimi 8bajtovymi useky. Bez dotazu na disk.
+// count bajtu od pozice depth jako cislo, za koncem retezce nuly (kratsi je mensi)
+static std::uint64_t chunkKey(const std::string& text, size_t depth, size_t count) {
+    std::uint64_t key = 0;
+    for (size_t i = depth; i < depth + count; ++i) {
+        key = (key << 8) | (i < text.size() ? static_cast<unsigned char>(text[i]) : 0);
+    }
+    return key;
+}
+
+static void appendBigEndian(std::string& out, std::uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+static std::string_view extensionOf(std::string_view name) {
+    size_t dot = name.rfind('.');
+    return (dot == std::string_view::npos || dot == 0) ? std::string_view() : name.substr(dot + 1);
+}
+
+static int compareNoCase(std::string_view a, std::string_view b) {
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        int d = lowerAscii(static_cast<unsigned char>(a[i])) - lowerAscii(static_cast<unsigned char>(b[i]));
+        if (d) {
+            return d;
+        }
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+}
+
+// prirozene porovnani: cisla uvnitr jmena se porovnavaji podle hodnoty (soubor9 < soubor10)
+static int compareNatural(std::string_view a, std::string_view b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        bool da = a[i] >= '0' && a[i] <= '9';
+        bool db = b[j] >= '0' && b[j] <= '9';
+        if (da && db) {
+            size_t si = i, sj = j;
+            while (si < a.size() && a[si] == '0') ++si; // uvodni nuly nerozhoduji
+            while (sj < b.size() && b[sj] == '0') ++sj;
+            size_t ei = si, ej = sj;
+            while (ei < a.size() && a[ei] >= '0' && a[ei] <= '9') ++ei;
+            while (ej < b.size() && b[ej] >= '0' && b[ej] <= '9') ++ej;
+            if (ei - si != ej - sj) {
+                return ei - si < ej - sj ? -1 : 1; // kratsi cislo je mensi
+            }
+            int d = a.substr(si, ei - si).compare(b.substr(sj, ej - sj));
+            if (d) {
+                return d;
+            }
+            i = ei;
+            j = ej;
+            continue;
+        }
+        int d = lowerAscii(static_cast<unsigned char>(a[i])) - lowerAscii(static_cast<unsigned char>(b[j]));
+        if (d) {
+            return d;
+        }
+        ++i;
+        ++j;
+    }
+    return (a.size() - i) < (b.size() - j) ? -1 : (a.size() - i) > (b.size() - j) ? 1 : 0;
+}
+
+void FilePanel::sortString(size_t i, std::string& out) const {
+    out.clear();
+    std::string_view name = entries.name(i);
+    switch (sortMode) {
+    case SortMode::Size:
+        appendBigEndian(out, entries.sizes[i]);
+        break;
+    case SortMode::Modified:
+        appendBigEndian(out, static_cast<std::uint64_t>(entries.mtimes[i]) ^ (1ull << 63)); // se znamenkem na bez znamenka
+        break;
+    case SortMode::Extension:
+        for (char c : extensionOf(name)) {
+            out.push_back(static_cast<char>(lowerAscii(static_cast<unsigned char>(c))));
+        }
+        out.push_back('\x01'); // kratsi pripona je mensi
+        break;
+    case SortMode::Natural:
+        for (size_t j = 0; j < name.size();) {
+            if (name[j] >= '0' && name[j] <= '9') { // cislo: '0', delka bez uvodnich nul, cislice
+                while (j < name.size() && name[j] == '0') ++j;
+                size_t start = j;
+                while (j < name.size() && name[j] >= '0' && name[j] <= '9') ++j;
+                out.push_back('0');
+                out.push_back(static_cast<char>(std::min<size_t>(j - start + 1, 255)));
+                out.append(name.substr(start, j - start));
+            }
+            else {
+                out.push_back(static_cast<char>(lowerAscii(static_cast<unsigned char>(name[j++]))));
+            }
+        }
+        return;
+    default:
+        break;
+    }
+    for (char c : name) {
+        out.push_back(static_cast<char>(lowerAscii(static_cast<unsigned char>(c))));
+    }
+}
+
+std::uint64_t FilePanel::computeSortKey(size_t i) const {
+    std::uint64_t key = 0; // 63 bitu hodnoty
+    if (sortNeedsMetadata()) {
+        key = sortMode == SortMode::Size ? entries.sizes[i] >> 1 // horni bit patri priznaku slozky
+            : (static_cast<std::uint64_t>(entries.mtimes[i]) ^ (1ull << 63)) >> 1;
+    }
+    else {
+        thread_local std::string text;
+        sortString(i, text);
+        key = chunkKey(text, 0, 7);
+    }
+    if (sortDescending) {
+        key = ~key & ((1ull << 63) - 1);
+    }
+    return (entries.isDirectory(i) ? 0 : 1ull << 63) | key;
+}
+
+bool FilePanel::lessEntry(std::uint32_t a, std::uint32_t b) const {
+    if (sortKeys[a] != sortKeys[b]) {
+        return sortKeys[a] < sortKeys[b];
+    }
+    std::string_view na = entries.name(a), nb = entries.name(b);
+    int d = 0;
+    switch (sortMode) {
+    case SortMode::Natural:
+        d = compareNatural(na, nb);
+        break;
+    case SortMode::Extension:
+        d = compareNoCase(extensionOf(na), extensionOf(nb));
+        break;
+    case SortMode::Size:
+        d = entries.sizes[a] < entries.sizes[b] ? -1 : entries.sizes[a] > entries.sizes[b] ? 1 : 0;
+        break;
+    case SortMode::Modified:
+        d = entries.mtimes[a] < entries.mtimes[b] ? -1 : entries.mtimes[a] > entries.mtimes[b] ? 1 : 0;
+        break;
+    default:
+        break;
+    }
+    if (!d) {
+        d = compareNoCase(na, nb);
+    }
+    if (!d) {
+        d = na.compare(nb);
+    }
+    if (sortDescending) {
+        d = -d;
+    }
+    return d ? d < 0 : a < b;
+}
+
+void FilePanel::sortEntries() {
+    const size_t n = entries.size();
+    std::int64_t selected = selectedTableIndex();
+    sortKeys.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        sortKeys[i] = computeSortKey(i);
+    }
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = static_cast<std::uint32_t>(i);
+    }
+    auto less = [this](std::uint32_t a, std::uint32_t b) { return lessEntry(a, b); };
+    const size_t radixThreshold = 4096; // pod touto hranici je std::sort rychlejsi
+    if (n < radixThreshold) {
+        std::sort(order.begin(), order.end(), less);
+    }
+    else {
+        // LSD radix sort po 16 bitech, pruchody se shodnou cifrou u vsech polozek se preskoci
+        std::vector<std::uint32_t> buffer(n);
+        std::vector<size_t> counts(1 << 16);
+        for (int shift = 0; shift < 64; shift += 16) {
+            std::fill(counts.begin(), counts.end(), 0);
+            for (std::uint32_t i : order) {
+                ++counts[(sortKeys[i] >> shift) & 0xFFFF];
+            }
+            if (counts[(sortKeys[order[0]] >> shift) & 0xFFFF] == n) {
+                continue;
+            }
+            size_t sum = 0;
+            for (auto& count : counts) {
+                size_t c = count;
+                count = sum;
+                sum += c;
+            }
+            for (std::uint32_t i : order) {
+                buffer[counts[(sortKeys[i] >> shift) & 0xFFFF]++] = i;
+            }
+            order.swap(buffer);
+        }
+        // polozky se shodnym klicem (stejny zacatek jmena, stejna velikost) se doradi dalsimi useky
+        for (size_t begin = 0; begin < n;) {
+            size_t end = begin + 1;
+            while (end < n && sortKeys[order[end]] == sortKeys[order[begin]]) {
+                ++end;
+            }
+            if (end - begin > 1) {
+                refineRun(begin, end, sortNeedsMetadata() ? 0 : 7);
+            }
+            begin = end;
+        }
+    }
+    if (!filter.empty()) {
+        refilter();
+    }
+    selectTableIndex(selected); // kurzor zustane na stejne polozce
+}
+
+void FilePanel::refineRun(size_t begin, size_t end, size_t depth) {
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> keyed(end - begin);
+    std::string text;
+    size_t longest = 0;
+    for (size_t i = begin; i < end; ++i) {
+        sortString(order[i], text);
+        std::uint64_t key = chunkKey(text, depth, 8);
+        keyed[i - begin] = { sortDescending ? ~key : key, order[i] };
+        longest = std::max(longest, text.size());
+    }
+    std::sort(keyed.begin(), keyed.end());
+    for (size_t i = begin; i < end; ++i) {
+        order[i] = keyed[i - begin].second;
+    }
+    for (size_t first = 0; first < keyed.size();) {
+        size_t last = first + 1;
+        while (last < keyed.size() && keyed[last].first == keyed[first].first) {
+            ++last;
+        }
+        if (last - first > 1) {
+            if (depth + 8 < longest) {
+                refineRun(begin + first, begin + last, depth + 8);
+            }
+            else { // retezce jsou shodne, rozhodne velikost pismen
+                std::sort(order.begin() + begin + first, order.begin() + begin + last,
+                    [this](std::uint32_t a, std::uint32_t b) { return lessEntry(a, b); });
+            }
+        }
+        first = last;
+    }
+}
+
+void FilePanel::insertSorted(std::uint32_t index) {
+    auto it = std::upper_bound(order.begin(), order.end(), index,
+        [this](std::uint32_t a, std::uint32_t b) { return lessEntry(a, b); });
+    order.insert(it, index);
+}
+
+void FilePanel::setSortMode(SortMode mode, bool descending) {
+    sortMode = mode;
+    sortDescending = descending;
+    if (loading()) {
+        return; // seradi se po dokonceni nacitani
+    }
+    if (sortNeedsMetadata()) {
+        ensureMetadata(order, 0, order.size()); // klice potrebuji velikost a cas vsech polozek
+    }
+    sortEntries();
+}
+
+const char* FilePanel::sortModeName() const {
+    static const char* names[] = { "jmeno", "prirozene", "velikost", "cas", "pripona" };
+    return names[static_cast<int>(sortMode)];
+}
+
+std::int64_t FilePanel::selectedTableIndex() const {
+    const auto& shown = visible();
+    return selectedIndex >= 0 && selectedIndex < static_cast<int>(shown.size()) ? static_cast<std::int64_t>(shown[selectedIndex]) : -1;
+}
+
+void FilePanel::selectTableIndex(std::int64_t index) {
+    const auto& shown = visible();
+    if (index >= 0) {
+        auto it = std::find(shown.begin(), shown.end(), static_cast<std::uint32_t>(index));
+        if (it != shown.end()) {
+            selectedIndex = static_cast<int>(it - shown.begin());
+            return;
+        }
+    }
+    selectedIndex = std::max(0, std::min(selectedIndex, static_cast<int>(shown.size()) - 1));
+}
+
+std::vector<std::uint32_t> FilePanel::matchFilter(const std::vector<std::uint32_t>& candidates) const {
+    std::string needle;
+    for (char c : filter) {
+        needle.push_back(static_cast<char>(lowerAscii(static_cast<unsigned char>(c))));
+    }
+    std::vector<std::uint32_t> result;
+    const char* limit = entries.names.data() + entries.names.size();
+    if (candidates.size() == entries.size()) {
+        // cely seznam: jeden pruchod arenou jmen, shoda se prevede na polozku posunem indexu
+        std::vector<std::uint8_t> hit(entries.size(), 0);
+        size_t index = 0;
+        findBytes<true>(entries.names.data(), entries.names.size(), needle, limit, [&](size_t position) {
+            while (index + 1 < entries.size() && entries.nameOffsets[index + 1] <= position) {
+                ++index;
+            }
+            hit[index] = 1;
+            return static_cast<size_t>(entries.nameOffsets[index]) + entries.nameLengths[index] + 1; // dalsi jmeno
+        });
+        for (std::uint32_t i : candidates) {
+            if (hit[i]) {
+                result.push_back(i);
+            }
+        }
+        return result;
+    }
+    for (std::uint32_t i : candidates) {
+        bool found = false;
+        findBytes<true>(entries.cname(i), entries.nameLengths[i], needle, limit, [&](size_t) {
+            found = true;
+            return static_cast<size_t>(entries.nameLengths[i]);
+        });
+        if (found) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+void FilePanel::appendFilter(char c) {
+    std::int64_t selected = selectedTableIndex();
+    const std::vector<std::uint32_t>& previous = visible();
+    filter.push_back(c);
+    std::vector<std::uint32_t> narrowed = matchFilter(previous); // novy filtr obsahuje stary, staci projit minuly vysledek
+    filtered.push_back(std::move(narrowed));
+    selectTableIndex(selected);
+}
+
+void FilePanel::popFilter() {
+    if (filter.empty()) {
+        return;
+    }
+    std::int64_t selected = selectedTableIndex();
+    filter.pop_back();
+    if (filtered.size() > 1) {
+        filtered.pop_back();
+    }
+    else if (!filter.empty()) {
+        filtered = { matchFilter(order) };
+    }
+    else {
+        filtered.clear();
+    }
+    selectTableIndex(selected);
+}
+
+void FilePanel::clearFilter() {
+    std::int64_t selected = selectedTableIndex();
+    filter.clear();
+    filtered.clear();
+    selectTableIndex(selected);
+}
+
+void FilePanel::refilter() {
+    filtered.clear(); // kratsi filtry se pripadne spocitaji znovu v popFilter
+    filtered.push_back(matchFilter(order));
+}
+
+void FilePanel::updateDirectorySizes(DirectorySizes& sizes, size_t first, size_t last) {
+    const auto& shown = visible();
+    last = std::min(last, shown.size());
+    for (size_t position = first; position < last; ++position) {
+        size_t i = shown[position];
+        if (!entries.isDirectory(i) || (entries.flags[i] & EntryTable::SizeKnown) || !entries.metaLoaded(i)) {
+            continue; // cas zmeny slozky je klic do cache, bez nej se nepocita
+        }
+        std::string path = (fs::path(currentPath) / entryPath(i)).string();
+        std::uint64_t bytes = 0;
+        bool partial = false;
+        if (sizes.lookup(path, entries.mtimes[i], bytes, partial)) {
+            entries.sizes[i] = bytes;
+            entries.flags[i] |= EntryTable::SizeKnown | (partial ? EntryTable::SizePartial : 0);
+        }
+        else {
+            sizes.request(path, entries.mtimes[i]);
+        }
+    }
+}
+
+void FilePanel::startGrep(const std::string& needle) {
+    std::vector<fs::path> roots = selectedPaths();
+    if (roots.empty()) {
+        roots.push_back(currentPath); // bez vyberu cela aktualni slozka
+    }
+    watcher.watch(std::string());
+    searchText = "text: " + needle;
+    selectedIndex = 0;
+    scrollOffset = 0;
+    clearSelection();
+    std::shared_ptr<DirectoryScan> state = beginScan();
+    launchScan(state, [state, needle, roots, base = fs::path(currentPath)] {
+        ContentGrep grep(needle, state->cancelled, [&](EntryTable& batch) {
+            state->loaded += batch.size();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->entries.append(batch);
+        });
+        grep.run(roots, base, ParallelFind::threadsFor(base.string()));
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->error = std::to_string(grep.filesScanned.load()) + " souboru, " + std::to_string(grep.binarySkipped.load()) + " binarnich preskoceno";
+        state->done = true;
+    });
+}
+
+std::string_view FilePanel::entryPath(size_t i) const {
+    std::string_view name = entries.name(i);
+    return name.substr(0, name.find('\0')); // vysledky hledani textu maji za cestou nulu a radek
+}
+
+fs::path FilePanel::selectedEntry() {
+    std::int64_t index = selectedTableIndex();
+    if (index < 0) return {};  // overuje zda je seznam entries prazdny nebo jeste nenacteny
+    return fs::path(currentPath) / entryPath(index);
+} // kdyz prazdny vrati promenou selectedIndex    
+
+void FilePanel::moveCursor(std::int64_t delta) {
+    std::int64_t last = static_cast<std::int64_t>(visible().size()) - 1;
+    selectedIndex = static_cast<int>(std::max<std::int64_t>(0, std::min(last, selectedIndex + delta)));
+} // PgUp/PgDn, Home/End a sloucene drzene w/s
+
+void FilePanel::enterDirectory() {
+    if (selectedTableIndex() >= 0 && entries.isDirectory(selectedTableIndex())) {
+        openDirectory(selectedEntry().string(), std::string()); // kurzor tam, kde byl pri poslednim odchodu
+        clearSelection();
+    } //vstoupeni do slozky, klavesa o
+}
+
+void FilePanel::goBack() {
+    if (!searchText.empty()) {
+        openDirectory(currentPath, std::string()); // z vysledku hledani zpet na obsah slozky
+        return;
+    }
+    if (currentPath != "/") {
+        fs::path child = currentPath;
+        openDirectory(child.parent_path().string(), child.filename().string()); // kurzor na slozku, ze ktere se prislo
+        clearSelection();
+    } // klavesa p, jit zpatky
+}
+
+void FilePanel::toggleSelection() {
+    std::int64_t index = selectedTableIndex();
+    if (index >= 0) {
+        setSelected(static_cast<size_t>(index), !isSelected(static_cast<size_t>(index))); // Přidání nebo zrušení výběru
+        selectionAnchor = index;
+    }
+}  // vyber jednotlivych souboru pro praci s nimi, klavesa m
+
+void FilePanel::clearSelection() {
+    selection.clear();
+    selectedCount = 0;
+    selectionAnchor = -1;
+    reselectNames.clear();
+} //odstraneni vsech vybranych souboru
+
+void FilePanel::setSelected(size_t i, bool selected) {
+    if (isSelected(i) == selected) {
+        return;
+    }
+    if (i / 64 >= selection.size()) {
+        selection.resize(entries.size() / 64 + 1);
+    }
+    selection[i / 64] ^= std::uint64_t(1) << (i % 64);
+    selected ? ++selectedCount : --selectedCount;
+}
+
+std::vector<fs::path> FilePanel::selectedPaths() const {
+    std::vector<fs::path> paths;
+    paths.reserve(selectedCount);
+    forEachSelected([&](size_t i) { paths.push_back(fs::path(currentPath) / entryPath(i)); });
+    return paths;
+}
+
+void FilePanel::selectRange() {
+    const auto& shown = visible();
+    if (selectedTableIndex() < 0) {
+        return;
+    }
+    size_t from = 0; // bez kotvy (nebo kdyz ji filtr skryl) od zacatku seznamu
+    auto anchor = std::find(shown.begin(), shown.end(), static_cast<std::uint32_t>(selectionAnchor));
+    if (selectionAnchor >= 0 && anchor != shown.end()) {
+        from = static_cast<size_t>(anchor - shown.begin());
+    }
+    size_t to = static_cast<size_t>(selectedIndex);
+    if (from > to) {
+        std::swap(from, to);
+    }
+    for (size_t position = from; position <= to; ++position) {
+        setSelected(shown[position], true);
+    }
+    selectionAnchor = shown[selectedIndex];
+}
+
+void FilePanel::selectAll() {
+    for (std::uint32_t i : visible()) {
+        setSelected(i, true);
+    }
+}
+
+void FilePanel::invertSelection() {
+    for (std::uint32_t i : visible()) {
+        setSelected(i, !isSelected(i));
+    }
+}
+
+void FilePanel::selectMatching(const FindQuery& query) {
+    const auto& shown = visible();
+    if (query.needsMetadata()) {
+        ensureMetadata(shown, 0, shown.size());
+    }
+    for (std::uint32_t i : shown) {
+        std::string_view path = entryPath(i);
+        size_t slash = path.rfind('/'); // ve vysledcich hledani se porovnava jen jmeno, ne cesta
+        if (query.matches(slash == std::string_view::npos ? path : path.substr(slash + 1), entries.info(i))) {
+            setSelected(i, true);
+        }
+    }
+}
+
+void FilePanel::createNewFile(std::string& message) {
+    std::cout << "Zadejte nazev noveho souboru: ";
+    std::string fileName;
+    std::cin >> fileName;
+    fs::path filePath = fs::path(currentPath) / fileName;
+    // vytvoreni noveho souboru, klavesa n
+    try {
+        std::ofstream(filePath.string()); // Vytvoří prázdný soubor
+        if (!watcher.active()) {
+            refreshEntries(); // jinak novy soubor prida applyWatchEvents
+        }
+        message = "Soubor \"" + fileName + "\" vytvoren.";
+    }
+    catch (const std::exception& e) {
+        message = std::string("Chyba pri vytvareni souboru: ") + e.what(); // chyba pri vytvareni
+    }
+}
+
+void FilePanel::createNewFolder(std::string& message) {
+    std::cout << "Zadejte nazev nove slozky: ";
+    std::string folderName;
+    std::cin >> folderName;
+    fs::path folderPath = fs::path(currentPath) / folderName;       // vytvareni nove slozky, klavesa k
+
+    try {
+        fs::create_directory(folderPath); // Vytvoření složky
+        if (!watcher.active()) {
+            refreshEntries();
+        }
+
+    }
+    catch (const std::exception& e) {
+        message = std::string("Chyba pri vytvareni slozky: ") + e.what();
+    }
+}
+
+void FilePanel::deleteSelectedFile(JobQueue& jobs, std::string& message) {
+    if (selectedCount == 0 && selectedTableIndex() < 0) {
+        message = "Zadny soubor k odstraneni.";
+        return;
+    }            // funkce na smazani souboru, klavesa l
+
+    std::vector<fs::path> paths = selectedPaths(); // oznacene polozky, jinak ta pod kurzorem
+    if (paths.empty()) {
+        paths.push_back(selectedEntry());
+        std::string name = paths.front().filename().string();
+        replaceControlBytes(name); // dotaz se pise primo na terminal, mimo renderer
+        std::cout << "Opravdu chcete smazat \"" << name << "\"? (y/n): ";
+    }
+    else {
+        std::cout << "Opravdu chcete smazat " << paths.size() << " oznacenych polozek? (y/n): ";
+    }
+    char confirmation;
+    std::cin >> confirmation;
+
+    if (confirmation == 'y' || confirmation == 'Y') {        //potvrzeni volby smazani
+        jobs.submit(Job::Kind::Delete, std::move(paths)); // smaze se na pozadi, panel se obnovi podle prubehu
+        clearSelection();
+    }
+    else {
+        message = "Odstraneni zruseno.";
+    }
+}
+
+void FilePanel::scrollToSelection(size_t visibleRows) {
+    if (visibleRows == 0) {
+        return;
+    }
+    size_t selected = static_cast<size_t>(selectedIndex);
+    if (selected < scrollOffset) {
+        scrollOffset = selected; // kurzor odjel nahoru
+    }
+    else if (selected >= scrollOffset + visibleRows) {
+        scrollOffset = selected - visibleRows + 1; // kurzor odjel dolu
+    }
+    const size_t count = visible().size();
+    if (scrollOffset + visibleRows > count) {
+        scrollOffset = count > visibleRows ? count - visibleRows : 0; // po smazani nezustane prazdne misto
+    }
+}
+
+// Radek se pripisuje do bufferu, ktery si volajici drzi mezi snimky, takze po prvnim snimku uz nealokuje
+void FilePanel::displayRow(std::string& out, size_t rowIndex, bool isActive, int width, ColumnFormatter& columns) const {
+    size_t start = out.size();
+    if (rowIndex == 0) {
+        out += isActive ? ">>> " : "    ";
+        out += currentPath;
+        out += "  [";
+        out += sortModeName();
+        out += sortDescending ? " v]" : " ^]";
+        if (!filter.empty()) {
+            out += "  filtr \"";
+            out += filter;
+            out += "\": ";
+            appendNumber(out, visible().size());
+            out += '/';
+            appendNumber(out, order.size());
+        }
+        if (!searchText.empty()) {
+            out += "  hledani \"";
+            out += searchText;
+            out += '"';
+        }
+        if (selectedCount) {
+            out += "  oznaceno ";
+            appendNumber(out, selectedCount);
+        }
+        if (loading()) {
+            out += searchText.empty() ? "  (nacteno " : "  (nalezeno ";
+            appendNumber(out, entries.size());
+            out += " polozek...)";
+        }
+        else if (!scanError.empty()) {
+            out += "  (";
+            out += scanError;
+            out += ')';
+        }
+        padTo(out, start, static_cast<size_t>(width));
+    }
+    else if (scrollOffset + rowIndex - 1 < visible().size()) {
+        size_t position = scrollOffset + rowIndex - 1; // radky jsou relativni k viewportu
+        size_t index = visible()[position];
+        const EntryInfo info = entries.info(index);
+        out += position == static_cast<size_t>(selectedIndex) ? " > " : "   ";
+        out += isSelected(index) ? '*' : ' '; // Označení vybraného souboru
+        size_t nameStart = out.size();
+        out += entries.name(index);
+        size_t lineStart = out.find('\0', nameStart);
+        if (lineStart != std::string::npos) {
+            out[lineStart] = ':'; // vysledek hledani textu: cesta:radek: text
+        }
+        if (info.isDirectory) {
+            out += '/';
+        }
+        padTo(out, nameStart, static_cast<size_t>(width - 20));
+        columns.appendSize(out, info);
+        columns.appendTime(out, info);
+    }
+    else {
+        out.append(static_cast<size_t>(width), ' ');
+    }
+}  // struktura panelu
+
+void FilePanel::trashSelected(Trash& trash, JobQueue& jobs, std::string& message) {
+    std::vector<fs::path> paths = selectedPaths(); // oznacene polozky, jinak ta pod kurzorem
+    if (paths.empty() && selectedTableIndex() >= 0) {
+        paths.push_back(selectedEntry());
+    }
+    std::vector<Trash::Item> moved;
+    std::vector<fs::path> failed;
+    std::vector<std::string> errors; // kazda polozka se svou chybou, jako Job::addError
+    for (const auto& path : paths) {
+        Trash::Item item;
+        std::string error;
+        if (trash.moveToTrash(path, item, error)) {
+            moved.push_back(item);
+            jobs.markChanged(path.parent_path()); // panely bez inotify
+        }
+        else {
+            failed.push_back(path);
+            errors.push_back(path.string() + ": " + error);
+        }
+    }
+    if (!moved.empty()) {
+        trash.history.push_back(moved);
+        message = std::to_string(moved.size()) + " polozek presunuto do kose (b vrati zpet)";
+    }
+    clearSelection();
+    if (failed.empty()) {
+        return;
+    }
+    // jiny svazek nebo kos nejde zalozit: jedina spravna nahrada je trvale smazani, jen po potvrzeni
+    for (auto& error : errors) {
+        replaceControlBytes(error);
+        std::cout << error << "\n";
+    }
+    std::cout << failed.size() << " polozek nelze presunout do kose. Smazat trvale? (y/n): ";
+    char confirmation;
+    std::cin >> confirmation;
+    if (confirmation == 'y' || confirmation == 'Y') {
+        jobs.submit(Job::Kind::Delete, std::move(failed));
+    }
+}
+
+void FilePanel::restoreFromTrash(Trash& trash, std::string& message) {
+    std::vector<Trash::Item> items;
+    if (Trash::isTrashFiles(currentPath)) { // panel ukazuje kos: obnovi se oznacene nebo polozka pod kurzorem
+        std::vector<fs::path> paths = selectedPaths();
+        if (paths.empty() && selectedTableIndex() >= 0) {
+            paths.push_back(selectedEntry());
+        }
+        for (const auto& path : paths) {
+            items.push_back(Trash::itemFor(path));
+        }
+        clearSelection();
+    }
+    else if (!trash.history.empty()) { // jinak posledni smazani v tomto behu
+        items = std::move(trash.history.back());
+        trash.history.pop_back();
+    }
+    size_t restored = 0;
+    std::string errors;
+    for (const auto& item : items) {
+        std::string error;
+        if (trash.restore(item, error)) {
+            ++restored;
+        }
+        else {
+            errors += (errors.empty() ? "" : "; ") + item.original.string() + ": " + error;
+        }
+    }
+    message = "Obnoveno z kose: " + std::to_string(restored) + (errors.empty() ? "" : ", chyby: " + errors);
+}
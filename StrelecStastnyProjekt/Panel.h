@@ -0,0 +1,158 @@
+﻿// Panel.h: Jeden panel spravce: seznam polozek slozky, razeni, filtr, vyber,
+// postupne nacitani na pozadi a navaznost na hledani, ulohy a kos.
+
+#pragma once
+
+#include "TabulkaPolozek.h"
+#include "CteniSlozky.h"
+#include "HlidaniSlozky.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Postupne nacitani slozky na pozadi, panel si hotove davky prebira kazdy snimek
+struct DirectoryScan {
+    std::mutex mutex;
+    EntryTable entries; // davka, kterou si panel jeste neprevzal
+    bool done = false;
+    std::string error;
+    std::atomic<bool> cancelled{ false }; // panel uz zobrazuje jinou slozku
+    std::atomic<size_t> loaded{ 0 };
+    std::atomic<bool> exited{ false };    // vlakno nacitani skoncilo, join nebude cekat
+};
+
+struct FindQuery;
+struct DirectorySizes;
+struct Trash;
+struct JobQueue;
+struct ColumnFormatter;
+
+// Struktura pro reprezentaci panelu
+struct FilePanel {
+    std::string currentPath;
+    EntryTable entries;   // jmena a metadata polozek v currentPath
+    std::vector<std::uint32_t> order; // poradi zobrazeni: pozice -> index v entries
+    int selectedIndex;   // pozice v order
+    size_t scrollOffset; // pozice prvni zobrazene polozky (viewport)
+
+    enum class SortMode { Name, Natural, Size, Modified, Extension };
+    SortMode sortMode = SortMode::Name;
+    bool sortDescending = false;
+    std::vector<std::uint64_t> sortKeys; // predpocitane klice pro razeni, index v entries
+    std::string filter;  // filtr jmen psany z klavesnice, prazdny = vse
+    std::vector<std::vector<std::uint32_t>> filtered; // vysledky pro postupne delsi filtr, posledni se zobrazuje
+    std::vector<std::uint64_t> selection; // oznacene polozky pro hromadne operace, bit na index v entries
+    size_t selectedCount = 0;
+    std::int64_t selectionAnchor = -1; // index posledni polozky prepnute klavesou m, zacatek rozsahu pro M
+    std::vector<std::string> reselectNames; // vyber pred obnovenim slozky, po nacteni se oznaci znovu
+    std::shared_ptr<DirectoryScan> scan; // bezici nacitani, nullptr kdyz je seznam kompletni
+    std::string scanError; // chyba z posledniho nacitani, zobrazi se v hlavicce panelu
+    DirectoryWatcher watcher; // zmeny v currentPath, i ty zpusobene jinymi programy
+    struct ScanThread {
+        std::thread thread;
+        std::shared_ptr<DirectoryScan> state;
+    };
+    std::vector<ScanThread> scanThreads; // nacitani a hledani na pozadi, i zrusena, ktera jeste dobihaji
+
+    FilePanel(const std::string& path) : currentPath(path), selectedIndex(0), scrollOffset(0) {
+        refreshEntries();
+    }  // konstruktor, zacina jednotlivy panel, proto selectedindex 0, protoze prvni polozka v seznamu
+    ~FilePanel(); // zrusi a pripoji vsechna vlakna nacitani
+
+    std::string searchText; // neprazdny = panel zobrazuje vysledky hledani, jmena jsou cesty relativni k currentPath
+    std::string cursorName; // po dokonceni nacitani se kurzor presune na polozku s timto jmenem
+
+    // naposledy opustene slozky, navrat do nich je bez cteni disku; sdilene obema panely
+    struct CachedListing {
+        std::string path;
+        DirectoryStamp stamp;
+        EntryTable entries;
+        std::vector<std::uint32_t> order;
+        std::vector<std::uint64_t> sortKeys;
+        SortMode sortMode;
+        bool sortDescending;
+        std::string cursor; // jmeno polozky pod kurzorem pri odchodu
+    };
+    static inline std::list<CachedListing> listingCache; // nejnoveji pouzite na zacatku
+    static constexpr size_t listingCacheSlots = 16;
+    static constexpr size_t listingCacheEntries = 1 << 20; // soucet polozek ve vsech ulozenych seznamech
+
+    void refreshEntries(); // spusti nacitani na pozadi, polozky pribyvaji v pollScan
+    void openDirectory(const std::string& path, const std::string& cursor); // z cache, jinak refreshEntries
+    void storeListing();   // kompletni seznam currentPath se ulozi do cache, panel o nej prijde
+    bool restoreListing(); // true kdyz byl seznam currentPath v cache a stale plati
+    void selectName(std::string_view name); // kurzor na polozku podle jmena
+    void startFind(const FindQuery& query, const std::string& text); // klavesa f, vysledky pribyvaji v pollScan
+    void startGrep(const std::string& needle); // klavesa g, v oznacenych souborech nebo v cele slozce
+    std::string_view entryPath(size_t i) const; // jmeno polozky bez radku z hledani textu
+    void updateDirectorySizes(DirectorySizes& sizes, size_t first, size_t last); // velikosti slozek na pozicich [first, last)
+    void cancelScan();     // zastavi nacitani i hledani, nactene polozky zustanou
+    std::shared_ptr<DirectoryScan> beginScan(); // zrusi stare nacitani a vyprazdni seznam
+    void launchScan(const std::shared_ptr<DirectoryScan>& state, std::function<void()> body); // body na novem vlakne
+    void joinFinishedScans(); // pripoji dobehla vlakna, bezici neceka
+    bool pollScan();       // prevezme nactene davky, true kdyz se seznam zmenil
+    bool loading() const { return scan != nullptr; }
+    bool applyWatchEvents(); // zapracuje zmeny z inotify, true kdyz se seznam zmenil
+    fs::path selectedEntry(); // cela cesta polozky pod kurzorem, prazdna kdyz neni
+    void moveCursor(std::int64_t delta); // klavesy w/s, sipky, PgUp/PgDn, Home/End; na okraji seznamu se zastavi
+        void enterDirectory(); // klavesa o
+        void goBack(); // klavesa p
+        void toggleSelection();   // soubor/slozka
+    void clearSelection();    // zruseni vyberu
+    bool isSelected(size_t i) const { return i / 64 < selection.size() && (selection[i / 64] >> (i % 64) & 1); }
+    void setSelected(size_t i, bool selected);
+    std::vector<fs::path> selectedPaths() const; // cele cesty oznacenych polozek, jeden pruchod bitmapou
+    template <typename F> void forEachSelected(F&& onIndex) const { // index v entries kazde oznacene polozky
+        for (size_t word = 0; word < selection.size(); ++word) {
+            size_t i = word * 64;
+            for (std::uint64_t bits = selection[word]; bits; bits >>= 1, ++i) { // prazdna slova se preskoci cela
+                if (bits & 1) {
+                    onIndex(i);
+                }
+            }
+        }
+    }
+    // hromadne oznaceni zobrazenych polozek (s filtrem jen vyfiltrovanych), vzdy jeden pruchod seznamem
+    void selectRange();       // klavesa M, od posledni polozky z m po kurzor
+    void selectAll();         // klavesa A
+    void invertSelection();   // klavesa *
+    void selectMatching(const FindQuery& query); // klavesa +, vzor jmena, velikost, cas zmeny
+    void createNewFile(std::string& message);   // klavesa n
+    void createNewFolder(std::string& message); // klavesa k
+    void deleteSelectedFile(JobQueue& jobs, std::string& message); // klavesa L, trvale smazani na pozadi
+    void trashSelected(Trash& trash, JobQueue& jobs, std::string& message); // klavesa l, presun do kose
+    void restoreFromTrash(Trash& trash, std::string& message); // klavesa b
+    void scrollToSelection(size_t visibleRows); // posune viewport tak, aby byl kurzor videt
+    void displayRow(std::string& out, size_t rowIndex, bool isActive, int width, ColumnFormatter& columns) const; // pripoji radek k out
+    void ensureMetadata(size_t first, size_t last); // dotahne velikost a cas pro pozice [first, last)
+    void ensureMetadata(const std::vector<std::uint32_t>& indices, size_t first, size_t last);
+    // zobrazene polozky: cely serazeny seznam, nebo vysledek filtru; selectedIndex a scrollOffset jsou pozice v nem
+    const std::vector<std::uint32_t>& visible() const { return filter.empty() ? order : filtered.back(); }
+    std::int64_t selectedTableIndex() const; // index polozky pod kurzorem v entries, -1 kdyz neni
+    void selectTableIndex(std::int64_t index); // kurzor na danou polozku, kdyz neni videt, zustane pozice
+    void appendFilter(char c); // zuzi minuly vysledek, neprochazi znovu vsechna jmena
+    void popFilter();          // vrati predchozi vysledek
+    void clearFilter();
+    void refilter();           // po zmene seznamu (razeni, inotify, nacitani) spocita vysledek znovu
+    std::vector<std::uint32_t> matchFilter(const std::vector<std::uint32_t>& candidates) const;
+    bool sortNeedsMetadata() const { return sortMode == SortMode::Size || sortMode == SortMode::Modified; }
+    void setSortMode(SortMode mode, bool descending); // klavesy t a r
+    void sortEntries();  // seradi order podle sortMode, slozky vzdy napred
+    void sortString(size_t i, std::string& out) const; // bajty, jejichz poradi odpovida lessEntry
+    std::uint64_t computeSortKey(size_t i) const;
+    bool lessEntry(std::uint32_t a, std::uint32_t b) const; // uplne porovnani, pri shode klicu
+    void refineRun(size_t begin, size_t end, size_t depth); // doradi polozky se shodnym klicem
+    void insertSorted(std::uint32_t index);
+    const char* sortModeName() const;
+};
@@ -0,0 +1,9 @@
+﻿// PocitadloDotazu.h: Pocet dotazu na souborovy system od posledniho snimku (radek s pocitadly).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// zvysuji ho vycet slozky, panel, velikosti slozek i hledani textu, hlavni smycka ho vypise a vynuluje
+inline std::atomic<std::size_t> fsCalls{ 0 };
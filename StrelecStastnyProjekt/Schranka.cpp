@@ -0,0 +1,113 @@
+﻿// Schranka.cpp: Implementace Clipboard, viz Schranka.h
+
+#include "Schranka.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+std::uint32_t Clipboard::walk(std::uint32_t node, std::string_view path) {
+    for (size_t begin = 0; begin <= path.size();) {
+        size_t end = std::min(path.find('/', begin), path.size());
+        if (end > begin || (begin == 0 && node == 0)) { // prazdna soucast jen na zacatku, znaci absolutni cestu
+            node = child(node, path.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return node;
+}
+
+void Clipboard::mark(std::uint32_t node) {
+    if (node != 0 && !nodes[node].inClipboard) {
+        nodes[node].inClipboard = true;
+        ++count;
+    }
+}
+
+void Clipboard::add(const fs::path& file) {
+    mark(walk(0, file.generic_string()));
+}
+
+void Clipboard::add(std::string_view dir, std::string_view name) {
+    if (lastDirNode == 0 || dir != lastDir) {
+        lastDir = dir;
+        lastDirNode = walk(0, dir);
+    }
+    mark(walk(lastDirNode, name));
+}
+
+std::uint32_t Clipboard::child(std::uint32_t parent, std::string_view component) {
+    if ((nodes.size() + 1) * 2 > slots.size()) { // naplneni nejvys do poloviny
+        std::vector<std::uint32_t> grown(std::max<size_t>(64, slots.size() * 2), emptySlot);
+        for (std::uint32_t i = 1; i < nodes.size(); ++i) {
+            size_t slot = hash(nodes[i].parent, name(i)) & (grown.size() - 1);
+            while (grown[slot] != emptySlot) {
+                slot = (slot + 1) & (grown.size() - 1);
+            }
+            grown[slot] = i;
+        }
+        slots.swap(grown);
+    }
+    component = component.substr(0, 0xFFFF);
+    size_t slot = hash(parent, component) & (slots.size() - 1);
+    for (; slots[slot] != emptySlot; slot = (slot + 1) & (slots.size() - 1)) {
+        std::uint32_t existing = slots[slot];
+        if (nodes[existing].parent == parent && name(existing) == component) {
+            return existing;
+        }
+    }
+    slots[slot] = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back({ parent, static_cast<std::uint32_t>(names.size()), static_cast<std::uint16_t>(component.size()), false });
+    names.insert(names.end(), component.begin(), component.end());
+    return slots[slot];
+}
+
+void Clipboard::clear() {
+    nodes.assign(1, Node{ 0, 0, 0, false });
+    names = std::vector<char>(); // uvolni i rezervu po milionu cest
+    slots = std::vector<std::uint32_t>();
+    count = 0;
+    lastDirNode = 0;
+    cut = false;
+}
+
+std::vector<fs::path> Clipboard::paths() const {
+    // deti kazdeho uzlu vedle sebe a serazene podle jmena, pruchod do hloubky da cesty v poradi
+    std::vector<std::uint32_t> children(nodes.size() - 1);
+    for (std::uint32_t i = 1; i < nodes.size(); ++i) {
+        children[i - 1] = i;
+    }
+    std::sort(children.begin(), children.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return nodes[a].parent != nodes[b].parent ? nodes[a].parent < nodes[b].parent : name(a) < name(b);
+    });
+    std::vector<std::uint32_t> first(nodes.size() + 1, 0); // deti uzlu n jsou children[first[n], first[n + 1])
+    for (std::uint32_t i : children) {
+        ++first[nodes[i].parent + 1];
+    }
+    for (size_t n = 1; n < first.size(); ++n) {
+        first[n] += first[n - 1];
+    }
+    std::vector<fs::path> result;
+    result.reserve(count);
+    std::string path;
+    std::vector<std::pair<std::uint32_t, size_t>> stack; // uzel, delka cesty pred nim
+    for (std::uint32_t i = first[1]; i-- > first[0];) {
+        stack.push_back({ children[i], 0 });
+    }
+    while (!stack.empty()) {
+        auto [node, length] = stack.back();
+        stack.pop_back();
+        path.resize(length);
+        if (nodes[node].parent != 0) {
+            path += '/'; // absolutni cesta zacina prazdnou soucasti, takze i pred ni vznikne lomitko
+        }
+        path.append(name(node));
+        if (nodes[node].inClipboard) {
+            result.emplace_back(path.empty() ? "/" : path);
+        }
+        for (std::uint32_t i = first[node + 1]; i-- > first[node];) {
+            stack.push_back({ children[i], path.size() });
+        }
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+﻿// Schranka.h: Schranka pro kopirovani a presun, cesty ulozene jako strom po slozkach.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Struktura pro reprezentaci schránky
+// Cesty jsou ulozene jako strom po slozkach: spolecna rodicovska slozka statisicu souboru je v pameti jednou,
+// kazda polozka stoji jen uzel a sve jmeno. Unikatnost hlida hashovaci tabulka (rodic, jmeno) -> uzel.
+struct Clipboard {
+    struct Node {
+        std::uint32_t parent;
+        std::uint32_t nameOffset; // v arene names
+        std::uint16_t nameLength;
+        bool inClipboard;         // cesta tohoto uzlu je ve schrance (ne jen predek jine cesty)
+    };
+
+    std::vector<Node> nodes{ Node{ 0, 0, 0, false } }; // nodes[0] je koren
+    std::vector<char> names;
+    std::vector<std::uint32_t> slots; // otevrena adresace, index uzlu nebo emptySlot
+    size_t count = 0;                 // pocet cest ve schrance
+    std::string lastDir;              // polozky panelu prichazeji ze stejne slozky, jeji uzel se hleda jednou
+    std::uint32_t lastDirNode = 0;
+    bool cut = false; // true po vyjmuti (x), vlozeni pak soubory presune
+
+    static constexpr std::uint32_t emptySlot = 0xFFFFFFFF;
+
+    void add(const fs::path& file); // zajisteni unikatnosti, O(delka cesty)
+    void add(std::string_view dir, std::string_view name); // polozka panelu bez skladani fs::path
+    void clear();
+    bool empty() const { return count == 0; }
+    std::vector<fs::path> paths() const; // serazene stejne jako std::set<fs::path>, pro vlozeni
+
+private:
+    std::string_view name(std::uint32_t node) const { return { names.data() + nodes[node].nameOffset, nodes[node].nameLength }; }
+    static size_t hash(std::uint32_t parent, std::string_view name) {
+        return std::hash<std::string_view>()(name) ^ (parent * 0x9E3779B97F4A7C15ull);
+    }
+    std::uint32_t child(std::uint32_t parent, std::string_view name); // najde nebo zalozi uzel
+    std::uint32_t walk(std::uint32_t node, std::string_view path); // uzel cesty relativne k node
+    void mark(std::uint32_t node);
+};
@@ -0,0 +1,77 @@
+﻿// TabulkaPolozek.cpp: Pridavani, zhustovani a cteni polozek EntryTable.
+
+#include "TabulkaPolozek.h"
+
+#include <algorithm>
+
+EntryInfo EntryTable::info(size_t i) const {
+    EntryInfo info;
+    info.isDirectory = flags[i] & Directory;
+    info.isSymlink = flags[i] & Symlink;
+    info.metaLoaded = flags[i] & MetaLoaded;
+    info.sizeKnown = flags[i] & SizeKnown;
+    info.timeKnown = flags[i] & TimeKnown;
+    info.sizePartial = flags[i] & SizePartial;
+    info.size = sizes[i];
+    info.modified = static_cast<std::time_t>(mtimes[i]);
+    return info;
+}
+
+void EntryTable::setInfo(size_t i, const EntryInfo& info) {
+    flags[i] = (info.isDirectory ? Directory : 0) | (info.isSymlink ? Symlink : 0) | (info.metaLoaded ? MetaLoaded : 0)
+        | (info.sizeKnown ? SizeKnown : 0) | (info.timeKnown ? TimeKnown : 0) | (info.sizePartial ? SizePartial : 0);
+    sizes[i] = info.size;
+    mtimes[i] = static_cast<std::int64_t>(info.modified);
+}
+
+void EntryTable::push(std::string_view name, const EntryInfo& info) {
+    nameOffsets.push_back(static_cast<std::uint32_t>(names.size()));
+    nameLengths.push_back(static_cast<std::uint16_t>(std::min<size_t>(name.size(), 0xFFFF)));
+    names.insert(names.end(), name.begin(), name.begin() + nameLengths.back());
+    names.push_back('\0');
+    flags.push_back(0);
+    sizes.push_back(0);
+    mtimes.push_back(0);
+    setInfo(size() - 1, info);
+}
+
+void EntryTable::append(const EntryTable& other) {
+    std::uint32_t base = static_cast<std::uint32_t>(names.size());
+    names.insert(names.end(), other.names.begin(), other.names.end());
+    for (std::uint32_t offset : other.nameOffsets) {
+        nameOffsets.push_back(base + offset);
+    }
+    nameLengths.insert(nameLengths.end(), other.nameLengths.begin(), other.nameLengths.end());
+    flags.insert(flags.end(), other.flags.begin(), other.flags.end());
+    sizes.insert(sizes.end(), other.sizes.begin(), other.sizes.end());
+    mtimes.insert(mtimes.end(), other.mtimes.begin(), other.mtimes.end());
+}
+
+void EntryTable::compact(const std::vector<bool>& removed) {
+    size_t kept = 0;
+    size_t nameEnd = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (removed[i]) {
+            continue;
+        }
+        // jmena se posouvaji jen dopredu, kopie v miste je bezpecna
+        std::copy(names.begin() + nameOffsets[i], names.begin() + nameOffsets[i] + nameLengths[i] + 1, names.begin() + nameEnd);
+        nameOffsets[kept] = static_cast<std::uint32_t>(nameEnd);
+        nameEnd += nameLengths[i] + 1;
+        nameLengths[kept] = nameLengths[i];
+        flags[kept] = flags[i];
+        sizes[kept] = sizes[i];
+        mtimes[kept] = mtimes[i];
+        ++kept;
+    }
+    names.resize(nameEnd);
+    nameOffsets.resize(kept);
+    nameLengths.resize(kept);
+    flags.resize(kept);
+    sizes.resize(kept);
+    mtimes.resize(kept);
+}
+
+void EntryTable::clear() {
+    *this = EntryTable(); // i kapacita, velka slozka nenechava po sobe obsazenou pamet
+}
@@ -0,0 +1,47 @@
+﻿// TabulkaPolozek.h: Metadata polozek slozky a jejich sloupcove ulozeni (EntryTable).
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+// Metadata jedne polozky, nacitaji se jednou v refreshEntries a vykresleni cte uz jen z nich
+struct EntryInfo {
+    bool isDirectory = false;
+    bool isSymlink = false;   // hledani do odkazu na slozky nevstupuje
+    bool metaLoaded = false;  // velikost a cas uz jsou nactene (na Linuxu az pro zobrazene radky)
+    bool sizeKnown = false;   // false kdyz file_size selhal
+    bool timeKnown = false;   // false kdyz last_write_time selhal
+    bool sizePartial = false; // slozka: cast podstromu neslo precist, velikost je jen dolni odhad
+    std::uintmax_t size = 0;
+    std::time_t modified = 0;
+};
+
+// Polozky slozky jako sloupce: jmena za sebou v jednom bufferu (arena), typ, velikost a cas
+// v zhustenych polich. Na polozku pripada ~23 bajtu plus jmeno, bez alokace na polozku.
+struct EntryTable {
+    enum Flags : std::uint8_t { Directory = 1, MetaLoaded = 2, SizeKnown = 4, TimeKnown = 8, Symlink = 16, SizePartial = 32 };
+
+    std::vector<char> names;             // jmena ukoncena nulou, aby sla rovnou predat statx
+    std::vector<std::uint32_t> nameOffsets;
+    std::vector<std::uint16_t> nameLengths; // vysledky hledani jsou relativni cesty, delsi nez NAME_MAX
+    std::vector<std::uint8_t> flags;
+    std::vector<std::uint64_t> sizes;
+    std::vector<std::int64_t> mtimes;
+
+    size_t size() const { return flags.size(); }
+    bool empty() const { return flags.empty(); }
+    std::string_view name(size_t i) const { return { names.data() + nameOffsets[i], nameLengths[i] }; }
+    const char* cname(size_t i) const { return names.data() + nameOffsets[i]; }
+    bool isDirectory(size_t i) const { return flags[i] & Directory; }
+    bool metaLoaded(size_t i) const { return flags[i] & MetaLoaded; }
+
+    EntryInfo info(size_t i) const;
+    void setInfo(size_t i, const EntryInfo& info);
+    void push(std::string_view name, const EntryInfo& info);
+    void append(const EntryTable& other); // pripoji davku z nacitani
+    void compact(const std::vector<bool>& removed); // odstrani oznacene polozky jednim pruchodem
+    void clear(); // uvolni vse najednou
+};
@@ -0,0 +1,222 @@
+﻿// Terminal.cpp: Syrovy rezim terminalu a rozklad escape sekvenci, viz Terminal.h
+
+#include "Terminal.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <csignal>
+#endif
+
+void terminalSize(int& rows, int& cols) {
+    rows = 25; // vychozi velikost, kdyz vystup neni terminal
+    cols = 200;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) {
+        rows = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+        cols = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    }
+#else
+    winsize ws{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) {
+        rows = ws.ws_row;
+        cols = ws.ws_col;
+    }
+#endif
+}
+
+bool stderrIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stderr)) != 0;
+#else
+    return ::isatty(STDERR_FILENO) != 0;
+#endif
+}
+
+bool waitForInput(int timeoutMs, std::initializer_list<int> wakeFds) {
+    if (std::cin.rdbuf()->in_avail() > 0) {
+        return true; // zbytek minuleho radku
+    }
+#ifdef _WIN32
+    return WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), timeoutMs) == WAIT_OBJECT_0;
+#else
+    std::vector<pollfd> fds{ { STDIN_FILENO, POLLIN, 0 } };
+    for (int fd : wakeFds) {
+        if (fd >= 0) {
+            fds.push_back({ fd, POLLIN, 0 });
+        }
+    }
+    if (::poll(fds.data(), fds.size(), timeoutMs) <= 0) {
+        return false;
+    }
+    return fds[0].revents != 0;
+#endif
+}
+
+#ifndef _WIN32
+static termios originalTerminal; // obnovi se i pri Ctrl+C, jinak by shell zustal bez ozveny
+
+static void restoreTerminal(int signal) {
+    ::tcsetattr(STDIN_FILENO, TCSANOW, &originalTerminal);
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+#endif
+
+TerminalInput::TerminalInput() {
+#ifndef _WIN32
+    if (::isatty(STDIN_FILENO) && ::tcgetattr(STDIN_FILENO, &originalTerminal) == 0) {
+        std::signal(SIGINT, restoreTerminal);
+        std::signal(SIGTERM, restoreTerminal);
+        std::signal(SIGHUP, restoreTerminal);
+        setRaw(true);
+        raw = true;
+    }
+#endif
+}
+
+TerminalInput::~TerminalInput() {
+    if (raw) {
+        setRaw(false);
+    }
+}
+
+void TerminalInput::setRaw(bool on) {
+#ifndef _WIN32
+    termios mode = originalTerminal;
+    if (on) {
+        mode.c_lflag &= ~(ICANON | ECHO); // ISIG zustava, Ctrl+C program ukonci
+        mode.c_cc[VMIN] = 1;
+        mode.c_cc[VTIME] = 0;
+    }
+    ::tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+#else
+    (void)on;
+#endif
+}
+
+TerminalInput::LineMode::LineMode(TerminalInput& input) : input(input) {
+    ++input.prompts;
+    if (input.raw) {
+        input.setRaw(false);
+        input.pending.clear(); // znaky napsane za klavesou dotazu se nesmi provest jako prikazy
+    }
+}
+
+TerminalInput::LineMode::~LineMode() {
+    if (input.raw) {
+        if (std::cin.rdbuf()->in_avail() > 0) {
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // konec radku po >> slove
+        }
+        input.setRaw(true);
+    }
+}
+
+bool TerminalInput::read(bool wholeLine) {
+    if (!raw) {
+        char ch;
+        if (!(wholeLine ? std::cin.get(ch) : std::cin >> ch)) {
+            return false;
+        }
+        pending.push_back(static_cast<unsigned char>(ch));
+        return true;
+    }
+#ifndef _WIN32
+    char buffer[4096];
+    while (true) {
+        ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        bytes.append(buffer, static_cast<size_t>(count));
+        // drzena klavesa posila znaky rychleji nez se kresli, vse uz prectene se zpracuje naraz
+        pollfd fd{ STDIN_FILENO, POLLIN, 0 };
+        if (::poll(&fd, 1, 0) > 0) {
+            continue;
+        }
+        // samotny Esc se od zacatku sekvence pozna jen tak, ze zbytek neprijde ani za chvili
+        if (escapeIncomplete() && ::poll(&fd, 1, 25) > 0) {
+            continue;
+        }
+        break;
+    }
+    decode();
+#endif
+    return true;
+}
+
+bool TerminalInput::escapeIncomplete() const {
+    size_t start = bytes.rfind('\x1b');
+    if (start == std::string::npos) {
+        return false;
+    }
+    if (start + 1 == bytes.size()) {
+        return true;
+    }
+    if (bytes[start + 1] != '[' && bytes[start + 1] != 'O') {
+        return false;
+    }
+    return bytes.find_first_not_of("0123456789;", start + 2) == std::string::npos; // chybi koncovy znak
+}
+
+void TerminalInput::decode() {
+    size_t i = 0;
+    while (i < bytes.size()) {
+        unsigned char ch = static_cast<unsigned char>(bytes[i]);
+        if (ch != 27) {
+            pending.push_back(ch);
+            ++i;
+            continue;
+        }
+        if (i + 1 >= bytes.size() || (bytes[i + 1] != '[' && bytes[i + 1] != 'O')) {
+            pending.push_back(27); // samotny Esc
+            ++i;
+            continue;
+        }
+        // CSI: ESC [ parametry koncovy znak, SS3: ESC O znak
+        size_t end = i + 2;
+        while (end < bytes.size() && ((bytes[end] >= '0' && bytes[end] <= '9') || bytes[end] == ';')) {
+            ++end;
+        }
+        if (end >= bytes.size()) {
+            pending.push_back(27); // useknuta sekvence, zbytek se vezme jako znaky
+            ++i;
+            continue;
+        }
+        int parameter = std::atoi(bytes.c_str() + i + 2);
+        switch (bytes[end]) {
+        case 'A': pending.push_back(Up); break;
+        case 'B': pending.push_back(Down); break;
+        case 'C': pending.push_back(Right); break;
+        case 'D': pending.push_back(Left); break;
+        case 'H': pending.push_back(Home); break;
+        case 'F': pending.push_back(End); break;
+        case '~':
+            if (parameter == 1 || parameter == 7) pending.push_back(Home);
+            else if (parameter == 4 || parameter == 8) pending.push_back(End);
+            else if (parameter == 5) pending.push_back(PageUp);
+            else if (parameter == 6) pending.push_back(PageDown);
+            break; // Insert, Delete, F5... se ignoruji
+        default:
+            break; // neznama sekvence se zahodi cela, aby se jeji znaky nebraly jako prikazy
+        }
+        i = end + 1;
+    }
+    bytes.clear();
+}
@@ -0,0 +1,52 @@
+﻿// Terminal.h: Velikost terminalu, cekani na vstup a cteni klaves (TerminalInput).
+
+#pragma once
+
+#include <deque>
+#include <initializer_list>
+#include <string>
+
+// Funkce pro zjisteni velikosti terminalu (pocet radku a sloupcu)
+void terminalSize(int& rows, int& cols);
+
+// Chyby uloh se na stderr vypisuji jen do souboru nebo roury, v terminalu by je prepsal pristi snimek
+bool stderrIsTerminal();
+
+// Ceka na klavesu nejvyse timeoutMs milisekund, false kdyz nic neprislo (snimek se prekresli)
+// Ceka se i na wakeFds (napr. inotify), jejich aktivita take vrati false a snimek se prekresli.
+bool waitForInput(int timeoutMs, std::initializer_list<int> wakeFds = {});
+
+// Klavesy bez Enteru: terminal se prepne do rezimu bez ICANON a ECHO a bajty se ctou primo z stdin.
+// Escape sekvence sipek a PgUp/PgDn/Home/End se prevedou na jeden kod klavesy. Neni-li stdin terminal
+// (prikazy ze skriptu), cte se po slovech pres std::cin jako drive.
+struct TerminalInput {
+    enum Key : int { Up = 0x100, Down, Left, Right, PageUp, PageDown, Home, End };
+
+    bool raw = false;
+    std::deque<int> pending; // prectene a jeste nezpracovane klavesy
+    unsigned prompts = 0;    // kolikrat se cetlo po radcich, tj. psalo se na terminal mimo renderer
+
+    TerminalInput();
+    ~TerminalInput();
+    TerminalInput(const TerminalInput&) = delete;
+    TerminalInput& operator=(const TerminalInput&) = delete;
+    // pripoji do pending vse, co je k dispozici, false pri konci vstupu; bez terminalu se
+    // s wholeLine (filtr) ctou i mezery a konce radku, jinak jen slova
+    bool read(bool wholeLine = false);
+    static bool isNavigation(int key) {
+        return key == 'w' || key == 's' || key == Up || key == Down || key == PageUp || key == PageDown || key == Home || key == End;
+    }
+
+    // dotazy (jmeno souboru, potvrzeni, hledany text) se ctou po radcich s ozvenou
+    struct LineMode {
+        TerminalInput& input;
+        explicit LineMode(TerminalInput& input);
+        ~LineMode();
+    };
+
+private:
+    std::string bytes; // prectene a jeste nerozlozene bajty
+    void setRaw(bool on);
+    bool escapeIncomplete() const; // bajty konci zacatkem escape sekvence
+    void decode();
+};
@@ -0,0 +1,340 @@
+﻿// Ulohy.cpp: Prubeh, stavovy radek a fronta uloh, viz Ulohy.h
+
+#include "Ulohy.h"
+#include "KopirovaniStromu.h"
+#include "MazaniStromu.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cerrno>
+#endif
+
+// implementace uloh na pozadi
+bool JobProgress::checkpoint() const {
+    if (paused && !cancelled) { // bez pauzy se zamek vubec nebere
+        std::unique_lock<std::mutex> lock(pauseMutex);
+        resumed.wait(lock, [this] { return !paused || cancelled; });
+    }
+    return !cancelled;
+}
+
+void JobProgress::setPaused(bool on) {
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex); // jinak by se zmena mohla ztratit mezi testem a wait
+        paused = on;
+    }
+    resumed.notify_all();
+}
+
+void JobProgress::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+        cancelled = true;
+    }
+    resumed.notify_all();
+}
+
+void Job::addError(const fs::path& path, const std::string& what) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    errors.push_back(path.string() + ": " + what);
+}
+
+size_t Job::errorCount() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return errors.size();
+}
+
+// velikost v citelnych jednotkach pro stavovy radek
+static std::string formatBytes(double bytes) {
+    const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    int unit = 0;
+    while (bytes >= 1024 && unit < 4) {
+        bytes /= 1024;
+        ++unit;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), unit ? "%.1f %s" : "%.0f %s", bytes, units[unit]);
+    return buffer;
+}
+
+std::string Job::statusLine() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - sampleTime).count();
+    if (elapsed >= 1.0) { // rychlost z posledni vteriny, pri pauze klesne na nulu
+        std::uintmax_t done = progress.bytesDone;
+        bytesPerSecond = (done - sampleBytes) / elapsed;
+        sampleBytes = done;
+        sampleTime = now;
+    }
+    static const char* names[] = { "Kopirovani", "Presun", "Mazani" };
+    std::string line = "[";
+    line += std::to_string(id); // "[" + std::to_string(...) hlasi GCC 12 v -O2 falesne jako -Wrestrict
+    line += "] ";
+    line += names[static_cast<int>(kind)];
+    if (state == State::Waiting) {
+        return line + " ceka ve fronte";
+    }
+    line += ": " + std::to_string(progress.filesDone.load()) + "/" + std::to_string(progress.filesTotal.load())
+        + (progress.scanDone ? "" : "+") + " souboru";
+    if (kind != Kind::Delete) {
+        line += ", " + formatBytes(static_cast<double>(progress.bytesDone)) + "/" + formatBytes(static_cast<double>(progress.bytesTotal))
+            + ", " + formatBytes(bytesPerSecond) + "/s";
+        std::uintmax_t remaining = progress.bytesTotal - std::min(progress.bytesTotal.load(), progress.bytesDone.load());
+        if (progress.scanDone && bytesPerSecond > 0) {
+            long long eta = static_cast<long long>(remaining / bytesPerSecond);
+            line += ", zbyva " + std::to_string(eta / 60) + ":" + (eta % 60 < 10 ? "0" : "") + std::to_string(eta % 60);
+        }
+    }
+    if (progress.paused) {
+        line += " (pozastaveno)";
+    }
+    return line;
+}
+
+JobQueue::JobQueue(size_t runnerCount) {
+    for (size_t i = 0; i < runnerCount; ++i) {
+        runners.emplace_back(&JobQueue::runner, this);
+    }
+}
+
+JobQueue::~JobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (auto& job : jobs) {
+            job->progress.cancel(); // pri ukonceni programu se rozpracovane ulohy zrusi
+        }
+    }
+    wakeUp.notify_all();
+    for (auto& t : runners) {
+        t.join();
+    }
+}
+
+std::shared_ptr<Job> JobQueue::submit(Job::Kind kind, std::vector<fs::path> sources, const fs::path& targetDir) {
+    auto job = std::make_shared<Job>();
+    job->kind = kind;
+    job->sources = std::move(sources);
+    job->targetDir = targetDir;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->id = nextId++;
+        waiting.push_back(job);
+        jobs.push_back(job);
+    }
+    wakeUp.notify_one();
+    return job;
+}
+
+std::shared_ptr<Job> JobQueue::newestActive() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = jobs.rbegin(); it != jobs.rend(); ++it) {
+        if ((*it)->state != Job::State::Finished) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<Job>> JobQueue::takeFinished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::shared_ptr<Job>> finished;
+    for (auto it = jobs.begin(); it != jobs.end();) {
+        if ((*it)->state == Job::State::Finished) {
+            finished.push_back(*it);
+            it = jobs.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    return finished;
+}
+
+std::set<std::string> JobQueue::takeChangedDirs() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::set<std::string> dirs;
+    dirs.swap(changedDirs);
+    return dirs;
+}
+
+void JobQueue::markChanged(const fs::path& dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    changedDirs.insert(dir.string());
+}
+
+void JobQueue::runner() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || !waiting.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = waiting.front();
+            waiting.pop_front();
+        }
+        job->state = Job::State::Running;
+        switch (job->kind) {
+        case Job::Kind::Copy:
+            runCopy(*job);
+            break;
+        case Job::Kind::Move:
+            runMove(*job);
+            break;
+        case Job::Kind::Delete:
+            runDelete(*job);
+            break;
+        }
+        job->state = Job::State::Finished;
+    }
+}
+
+// Prubezne obnovovani panelu behem ulohy. Konec ulohy vlakno probudi hned, jinak by kazda
+// i drobna uloha trvala nejmene do dalsiho tiku.
+struct PeriodicRefresh {
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    std::thread thread; // posledni, startuje az po ostatnich clenech
+
+    explicit PeriodicRefresh(std::function<void()> tick) : thread([this, tick] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::milliseconds(500), [this] { return done; })) {
+            lock.unlock();
+            tick();
+            lock.lock();
+        }
+    }) {}
+    ~PeriodicRefresh() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+};
+
+void JobQueue::runCopy(Job& job) {
+    std::vector<CopyEngine::Task> items;
+    for (const auto& source : job.sources) {
+        items.push_back({ source, job.targetDir / source.filename() });
+    }
+    CopyEngine engine(job);
+    {
+        PeriodicRefresh refresher([&] { markChanged(job.targetDir); }); // panel s cilem se obnovuje prubezne, ne az na konci
+        engine.run(items);
+    }
+    job.methods = engine.methodSummary();
+    markChanged(job.targetDir);
+}
+
+// Na stejnem svazku (stejne st_dev) je presun jedno renameat2 bez ohledu na velikost stromu,
+// mezi svazky se kopiruje a kazdy soubor se smaze hned po overeni kopie.
+void JobQueue::runMove(Job& job) {
+    std::vector<CopyEngine::Task> crossDevice;
+    std::set<fs::path> parents{ job.targetDir };
+    job.progress.filesTotal = job.sources.size();
+#ifdef __linux__
+    struct stat target {};
+    bool targetKnown = ::stat(job.targetDir.c_str(), &target) == 0;
+#endif
+    for (const auto& source : job.sources) {
+        if (!job.progress.checkpoint()) {
+            break;
+        }
+        fs::path destination = job.targetDir / source.filename();
+        parents.insert(source.parent_path());
+        int error = 0;
+#ifdef __linux__
+        struct stat st {};
+        if (::lstat(source.c_str(), &st) != 0) {
+            error = errno;
+        }
+        else if (targetKnown && st.st_dev != target.st_dev) {
+            error = EXDEV; // jiny svazek, rename nema smysl zkouset
+        }
+        else if (::renameat2(AT_FDCWD, source.c_str(), AT_FDCWD, destination.c_str(), RENAME_NOREPLACE) != 0) {
+            error = errno;
+            if (error == EINVAL || error == ENOSYS) { // FS bez RENAME_NOREPLACE (napr. starsi NFS)
+                std::error_code ec;
+                error = fs::exists(fs::symlink_status(destination, ec)) ? EEXIST
+                    : ::rename(source.c_str(), destination.c_str()) != 0 ? errno : 0;
+            }
+        }
+#else
+        std::error_code ec;
+        if (fs::exists(destination, ec)) {
+            error = EEXIST;
+        }
+        else {
+            fs::rename(source, destination, ec);
+            error = ec ? (ec == std::errc::cross_device_link ? EXDEV : ec.value()) : 0;
+        }
+#endif
+        if (error == EXDEV) { // i bind mount se stejnym st_dev
+            --job.progress.filesTotal; // polozku nahradi pocty souboru z kopirovani
+            std::error_code ec;
+            fs::file_status status = fs::symlink_status(source, ec);
+            if (!ec && !fs::is_directory(status) && !fs::is_regular_file(status) && !fs::is_symlink(status)) {
+                // FIFO ani zarizeni kopie s mazanim neprenese, zustava na miste
+                job.addError(source, "neni obycejny soubor (FIFO, socket nebo zarizeni), na jiny svazek nelze presunout");
+            }
+            else {
+                crossDevice.push_back({ source, destination }); // uvnitr slozek preskoci specialni soubory CopyEngine::walk
+            }
+        }
+        else if (error == EEXIST) {
+            job.addError(destination, "cil uz existuje");
+        }
+        else if (error) {
+            job.addError(source, std::generic_category().message(error));
+        }
+        else {
+            ++job.progress.filesDone;
+        }
+    }
+    if (!crossDevice.empty() && !job.progress.cancelled) {
+        CopyEngine engine(job);
+        engine.removeSources = true;
+        {
+            PeriodicRefresh refresher([&] { // zdroj ubyva a cil pribyva prubezne
+                for (const auto& parent : parents) {
+                    markChanged(parent);
+                }
+            });
+            engine.run(crossDevice);
+        }
+        job.methods = engine.methodSummary();
+    }
+    job.progress.scanDone = true;
+    for (const auto& parent : parents) {
+        markChanged(parent);
+    }
+}
+
+void JobQueue::runDelete(Job& job) {
+    std::set<fs::path> parents;
+    for (const auto& source : job.sources) {
+        parents.insert(source.parent_path());
+    }
+    {
+        PeriodicRefresh refresher([&] { // panely se slozkami se obnovuji prubezne
+            for (const auto& parent : parents) {
+                markChanged(parent);
+            }
+        });
+        DeleteEngine(job).run(job.sources); // cela vicenasobna vyber najednou, podstromy paralelne
+    }
+    for (const auto& parent : parents) {
+        markChanged(parent);
+    }
+}
@@ -0,0 +1,87 @@
+﻿// Ulohy.h: Ulohy na pozadi (kopirovani, presun, mazani), jejich prubeh a fronta.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Prubeh a ovladani dlouhe operace, sdileny mezi pracovnimi vlakny a hlavnim vlaknem
+struct JobProgress {
+    std::atomic<size_t> filesDone{ 0 };
+    std::atomic<size_t> filesTotal{ 0 };
+    std::atomic<std::uintmax_t> bytesDone{ 0 };
+    std::atomic<std::uintmax_t> bytesTotal{ 0 };
+    std::atomic<bool> scanDone{ false };  // celkove pocty uz jsou konecne
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> paused{ false };
+
+    bool checkpoint() const; // pri pauze ceka, vraci false kdyz je uloha zrusena
+    void setPaused(bool on); // obe zmeny probudi vlakna cekajici v checkpoint
+    void cancel();
+
+private:
+    mutable std::mutex pauseMutex;
+    mutable std::condition_variable resumed;
+};
+
+// Uloha na pozadi (kopirovani, presun, mazani)
+struct Job {
+    enum class Kind { Copy, Move, Delete };
+    enum class State { Waiting, Running, Finished };
+
+    int id = 0;
+    Kind kind = Kind::Copy;
+    std::vector<fs::path> sources;
+    fs::path targetDir;        // cil kopie a presunu
+    JobProgress progress;
+    std::atomic<State> state{ State::Waiting };
+    std::mutex errorMutex;
+    std::vector<std::string> errors; // chyby se sbiraji, uloha pokracuje
+    std::string methods;       // zpusoby kopirovani, vyplni se na konci
+
+    // mereni rychlosti, jen z hlavniho vlakna
+    std::chrono::steady_clock::time_point sampleTime = std::chrono::steady_clock::now();
+    std::uintmax_t sampleBytes = 0;
+    double bytesPerSecond = 0;
+
+    void addError(const fs::path& path, const std::string& what);
+    size_t errorCount();
+    std::string statusLine();
+};
+
+// Fronta uloh, ktere bezi na pracovnich vlaknech a neblokuji navigaci
+struct JobQueue {
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::shared_ptr<Job>> waiting;
+    std::vector<std::shared_ptr<Job>> jobs;   // vsechny nenahlasene ulohy, pro stavovy radek
+    std::set<std::string> changedDirs;        // slozky, ktere je treba v panelech obnovit
+    std::vector<std::thread> runners;
+    bool stopping = false;
+    int nextId = 1;
+
+    explicit JobQueue(size_t runnerCount = 2);
+    ~JobQueue();
+
+    std::shared_ptr<Job> submit(Job::Kind kind, std::vector<fs::path> sources, const fs::path& targetDir = {});
+    std::shared_ptr<Job> newestActive(); // na tuto ulohu pusobi pauza a zruseni
+    std::vector<std::shared_ptr<Job>> takeFinished();
+    std::set<std::string> takeChangedDirs();
+    void markChanged(const fs::path& dir);
+    void runner();
+    void runCopy(Job& job);
+    void runMove(Job& job);
+    void runDelete(Job& job);
+};
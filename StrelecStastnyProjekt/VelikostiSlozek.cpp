@@ -0,0 +1,199 @@
+﻿// VelikostiSlozek.cpp: Cache velikosti a pruchod podstromem, viz VelikostiSlozek.h
+
+#include "VelikostiSlozek.h"
+#include "CteniSlozky.h"
+#include "PocitadloDotazu.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <cstring>
+#endif
+
+namespace fs = std::filesystem;
+
+DirectorySizes::DirectorySizes(size_t threadCount) {
+    for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+        threads.emplace_back(&DirectorySizes::worker, this);
+    }
+}
+
+DirectorySizes::~DirectorySizes() {
+    stopping = true; // rozdelany pruchod skonci u nejblizsi polozky
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+DirectorySizes::Result& DirectorySizes::touch(const std::string& path) {
+    auto it = cache.find(path);
+    if (it != cache.end()) {
+        recent.splice(recent.begin(), recent, it->second.recent);
+        return it->second;
+    }
+    // rozpocitane zaznamy zustanou, vysledek pracovniho vlakna se do nich jeste zapise
+    for (auto victim = recent.end(); cache.size() >= cacheLimit && victim != recent.begin();) {
+        --victim;
+        auto found = cache.find(*victim);
+        if (!found->second.queued) {
+            cache.erase(found);
+            victim = recent.erase(victim);
+        }
+    }
+    recent.push_front(path);
+    Result& result = cache[path];
+    result.recent = recent.begin();
+    return result;
+}
+
+bool DirectorySizes::lookup(const std::string& path, std::int64_t mtime, std::uint64_t& bytes, bool& partial) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(path);
+    if (it == cache.end() || it->second.mtime != mtime || !it->second.done) {
+        return false;
+    }
+    recent.splice(recent.begin(), recent, it->second.recent);
+    bytes = it->second.bytes;
+    partial = it->second.partial;
+    return true;
+}
+
+void DirectorySizes::request(const std::string& path, std::int64_t mtime) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Result& result = touch(path);
+    if (result.mtime == mtime && (result.done || result.queued)) {
+        return; // hotovo nebo uz se pocita
+    }
+    result.mtime = mtime;
+    result.done = false;
+    result.queued = true;
+    ++inFlight;
+    queue.emplace_back(path, mtime);
+    wake.notify_one();
+}
+
+bool DirectorySizes::busy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return inFlight > 0;
+}
+
+void DirectorySizes::worker() {
+    while (!stopping) {
+        std::pair<std::string, std::int64_t> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(queue.back());
+            queue.pop_back();
+        }
+        bool partial = false;
+        std::uint64_t bytes = measure(job.first, partial);
+        std::lock_guard<std::mutex> lock(mutex);
+        --inFlight;
+        auto it = cache.find(job.first);
+        if (it != cache.end() && it->second.mtime == job.second && !stopping) { // mezitim se slozka nezmenila, jinak ceka novejsi pozadavek
+            it->second.bytes = bytes;
+            it->second.partial = partial;
+            it->second.done = true;
+            it->second.queued = false;
+        }
+    }
+}
+
+#ifdef __linux__
+// Secte obsazene bloky v podstromu root. Pruchod neopousti zarizeni device, proto pro rozliseni
+// pevnych odkazu staci cislo inode. Otevrena je vzdy jen jedna slozka (a root): podslozky se
+// zapamatuji jako cesty relativne k root a otevrou se az po zavreni rodice, takze hloubka stromu
+// neomezuje pocet deskriptoru. Slozka, kterou nejde otevrit nebo docist, nastavi partial.
+static std::uint64_t sumTree(int root, std::uint64_t device, const std::atomic<bool>& stopping, bool& partial) {
+    std::unordered_set<std::uint64_t> linked; // inody souboru s vice odkazy
+    std::vector<std::string> pending{ "." };
+    std::vector<char> buffer(64 * 1024);
+    std::uint64_t total = 0;
+    while (!pending.empty() && !stopping) {
+        std::string dir = std::move(pending.back());
+        pending.pop_back();
+        int dirfd = openBelow(root, dir);
+        if (dirfd < 0) {
+            partial = true; // EMFILE, EACCES, smazana mezi ctenim rodice a otevrenim...
+            continue;
+        }
+        long length = 0;
+        while (!stopping && (length = ::syscall(SYS_getdents64, dirfd, buffer.data(), buffer.size())) > 0) {
+            for (long offset = 0; offset < length;) {
+                auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                offset += dirent->d_reclen;
+                const char* name = dirent->d_name;
+                if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+                    continue;
+                }
+                struct statx stx {};
+                ++fsCalls;
+                if (::statx(dirfd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                    STATX_TYPE | STATX_BLOCKS | STATX_NLINK | STATX_INO, &stx) != 0) {
+                    continue;
+                }
+                std::uint64_t dev = (static_cast<std::uint64_t>(stx.stx_dev_major) << 32) | stx.stx_dev_minor;
+                if (dev != device) {
+                    continue; // jiny svazek (treba /proc), stejne jako du -x
+                }
+                if (S_ISDIR(stx.stx_mode)) {
+                    total += stx.stx_blocks * 512;
+                    pending.push_back(dir == "." ? std::string(name) : dir + "/" + name);
+                    continue;
+                }
+                if (stx.stx_nlink > 1 && !linked.insert(stx.stx_ino).second) {
+                    continue; // dalsi pevny odkaz na uz zapocitany soubor
+                }
+                total += stx.stx_blocks * 512;
+            }
+        }
+        if (length < 0) {
+            partial = true;
+        }
+        ::close(dirfd);
+    }
+    return total;
+}
+#endif
+
+std::uint64_t DirectorySizes::measure(const std::string& path, bool& partial) {
+#ifdef __linux__
+    int dirfd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd < 0) {
+        partial = true;
+        return 0;
+    }
+    struct statx stx {};
+    if (::statx(dirfd, "", AT_EMPTY_PATH | AT_STATX_DONT_SYNC, STATX_TYPE | STATX_BLOCKS, &stx) != 0) {
+        ::close(dirfd);
+        partial = true;
+        return 0;
+    }
+    std::uint64_t device = (static_cast<std::uint64_t>(stx.stx_dev_major) << 32) | stx.stx_dev_minor;
+    std::uint64_t total = stx.stx_blocks * 512 + sumTree(dirfd, device, stopping, partial);
+    ::close(dirfd);
+    return total;
+#else
+    std::uint64_t total = 0;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, error);
+        it != fs::recursive_directory_iterator() && !stopping; it.increment(error)) {
+        if (it->is_regular_file(error)) {
+            total += it->file_size(error); // bez inode se pevne odkazy nerozlisi
+        }
+        partial = partial || error;
+    }
+    return total;
+#endif
+}
@@ -0,0 +1,55 @@
+﻿// VelikostiSlozek.h: Velikosti slozek (obsazene misto jako du) pocitane na pozadi.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Velikosti slozek (obsazene misto jako du) se pocitaji na pozadi, kazde vlakno prochazi jednu
+// slozku pres openat/getdents64/statx bez skladani cest. Soubory s vice pevnymi odkazy se
+// pocitaji jednou podle (zarizeni, inode); do jinych pripojenych svazku se nevstupuje.
+// Vysledky zustavaji v cache podle cesty a casu zmeny slozky, navrat do slozky je okamzity.
+struct DirectorySizes {
+    explicit DirectorySizes(size_t threadCount);
+    ~DirectorySizes();
+    DirectorySizes(const DirectorySizes&) = delete;
+    DirectorySizes& operator=(const DirectorySizes&) = delete;
+
+    // true kdyz je hotovo; partial: cast podstromu neslo otevrit, bytes je jen dolni odhad
+    bool lookup(const std::string& path, std::int64_t mtime, std::uint64_t& bytes, bool& partial);
+    void request(const std::string& path, std::int64_t mtime); // zaradi vypocet, pokud uz nebezi
+    bool busy(); // neco se pocita, obrazovka se ma obcas prekreslit
+
+private:
+    struct Result {
+        std::int64_t mtime = 0;
+        std::uint64_t bytes = 0;
+        bool done = false;
+        bool queued = false; // ceka ve fronte nebo se prave pocita
+        bool partial = false;
+        std::list<std::string>::iterator recent; // poloha v recent
+    };
+    static constexpr size_t cacheLimit = 4096; // slozek; jako u cache vypisu se zapomina nejdele nepouzita
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::pair<std::string, std::int64_t>> queue; // posledni pozadavek se zpracuje prvni (je na obrazovce)
+    std::unordered_map<std::string, Result> cache;
+    std::list<std::string> recent; // naposledy pouzite na zacatku
+    size_t inFlight = 0;
+    std::atomic<bool> stopping{ false };
+    std::vector<std::thread> threads;
+
+    Result& touch(const std::string& path); // najde nebo zalozi zaznam a posune ho na zacatek recent, pod mutexem
+    void worker();
+    std::uint64_t measure(const std::string& path, bool& partial);
+};
@@ -0,0 +1,95 @@
+﻿// Vykreslovani.cpp: Implementace TerminalRenderer, viz Vykreslovani.h
+
+#include "Vykreslovani.h"
+#include "Formatovani.h"
+#include "Terminal.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+TerminalRenderer::TerminalRenderer() {
+#ifdef _WIN32
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(console, &mode)) {
+        SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING); // zapnuti ANSI sekvenci
+    }
+#endif
+}
+
+size_t TerminalRenderer::columns(const std::string& text, size_t from, size_t to) {
+    size_t count = 0;
+    for (size_t i = from; i < to; ++i) {
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void TerminalRenderer::clip(std::string& line, int cols) {
+    size_t count = 0;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if ((static_cast<unsigned char>(line[i]) & 0xC0) != 0x80 && count++ == static_cast<size_t>(cols)) {
+            line.resize(i);
+            return;
+        }
+    }
+}
+
+void TerminalRenderer::render(std::vector<std::string>& lines) {
+    int rows, cols;
+    terminalSize(rows, cols);
+    out.clear();
+    if (rows != lastRows || cols != lastCols) {
+        front.clear(); // zmena velikosti, prekresli se vse
+        out += "\x1b[2J";
+        lastRows = rows;
+        lastCols = cols;
+    }
+    for (size_t r = 0; r < lines.size(); ++r) {
+        std::string& line = lines[r];
+        replaceControlBytes(line);
+        clip(line, cols);
+        const std::string empty;
+        const std::string& old = r < front.size() ? front[r] : empty;
+        if (line == old) {
+            continue;
+        }
+        size_t start = 0; // prvni rozdilny bajt
+        while (start < line.size() && start < old.size() && line[start] == old[start]) {
+            ++start;
+        }
+        while (start > 0 && (static_cast<unsigned char>(line[start]) & 0xC0) == 0x80) {
+            --start; // nezacinat uprostred znaku UTF-8
+        }
+        size_t endNew = line.size(); // konec rozdilu, spolecny konec radku se neposila
+        size_t endOld = old.size();
+        while (endNew > start && endOld > start && line[endNew - 1] == old[endOld - 1]) {
+            --endNew;
+            --endOld;
+        }
+        while (endNew < line.size() && (static_cast<unsigned char>(line[endNew]) & 0xC0) == 0x80) {
+            ++endNew;
+            ++endOld;
+        }
+        moveTo(r, columns(line, 0, start));
+        if (columns(line, start, endNew) == columns(old, start, endOld)) {
+            out.append(line, start, endNew - start); // zmenene bunky, zbytek radku sedi
+        }
+        else {
+            out.append(line, start, std::string::npos);
+            out += "\x1b[K"; // radek se zkratil nebo posunul, smazat zbytek
+        }
+    }
+    moveTo(lines.size(), 0);
+    out += "\x1b[J"; // smaze stare radky a hlasky pod snimkem, kurzor zustane na radku pro vstup
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cout.flush();
+    lastBytes = out.size();
+    front.swap(lines);
+}
@@ -0,0 +1,35 @@
+﻿// Vykreslovani.h: Diferencialni vykreslovani snimku na terminal.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Diferencialni vykreslovani: pamatuje si minuly snimek a na terminal posle jen zmenene casti radku
+struct TerminalRenderer {
+    std::vector<std::string> front; // co je prave na obrazovce
+    std::string out;                // vystupni buffer, zapisuje se jednim volanim
+    int lastRows = 0;
+    int lastCols = 0;
+    size_t lastBytes = 0;           // kolik bajtu sel minuly snimek
+
+    TerminalRenderer();
+
+    // sirka textu ve sloupcich, pokracovaci bajty UTF-8 se nepocitaji
+    static size_t columns(const std::string& text, size_t from, size_t to);
+    // zkrati radek na sirku terminalu, aby se nezalamoval a nerozhodil pozice
+    static void clip(std::string& line, int cols);
+
+    // po zapisu mimo renderer (dotaz, ozvena vstupu) front neodpovida obrazovce, pristi snimek se kresli cely
+    void invalidate() {
+        front.clear();
+        lastRows = 0;
+    }
+
+    void moveTo(size_t row, size_t col) {
+        out += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(col + 1) + "H";
+    }
+
+    void render(std::vector<std::string>& lines); // lines se po vykresleni stanou front
+};